@@ -56,10 +56,12 @@ POSSIBILITY OF SUCH DAMAGE.
 // Pointers are a peculiar case...typically 16-bit on AVR boards,
 // 32 bits elsewhere.  Try to accommodate both...
 
-#if !defined(__INT_MAX__) || (__INT_MAX__ > 0xFFFF)
- #define pgm_read_pointer(addr) ((void *)pgm_read_dword(addr))
-#else
- #define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
+#ifndef pgm_read_pointer
+ #if !defined(__INT_MAX__) || (__INT_MAX__ > 0xFFFF)
+  #define pgm_read_pointer(addr) ((void *)pgm_read_dword(addr))
+ #else
+  #define pgm_read_pointer(addr) ((void *)pgm_read_word(addr))
+ #endif
 #endif
 
 #ifndef min
@@ -556,6 +558,10 @@ void Adafruit_GFX::drawXBitmap(int16_t x, int16_t y,
     endWrite();
 }
 
+const uint8_t *Adafruit_GFX::classicGlyph(unsigned char c) {
+    return font + (c * 5);
+}
+
 // Draw a character
 void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c,
         uint16_t color, uint16_t bg, uint8_t size) {
@@ -42,6 +42,9 @@
 #else
  #define pgm_read_byte(addr) \
   (*(const unsigned char *)(addr)) ///< PROGMEM workaround for non-AVR
+ #ifndef memcpy_P
+  #define memcpy_P memcpy            ///< PROGMEM workaround for non-AVR
+ #endif
 #endif
 
 #if !defined(__ARM_ARCH) && !defined(ENERGIA) && !defined(ESP8266) && !defined(ESP32) && !defined(__arc__)
@@ -62,6 +65,16 @@
  #define WIRE_MAX 32                     ///< Use common Arduino core default
 #endif
 
+// Bus bytes it costs to open a new GDDRAM window rather than carry on
+// sending: on I2C, a transfer of the address, the control byte and the
+// six PAGEADDR/COLUMNADDR bytes, then the address and control byte that
+// restart the data; on SPI, just the six command bytes. With frame
+// diffing, a gap of unchanged bytes narrower than this is sent again.
+#define WINDOW_COST_I2C 10 ///< Bytes to re-address over I2C
+#define WINDOW_COST_SPI 6  ///< Bytes to re-address over SPI
+
+typedef unsigned int diff_word; ///< Frame diff compare unit, 16/32 bits
+
 #define ssd1306_swap(a, b) \
   (((a) ^= (b)), ((b) ^= (a)), ((a) ^= (b))) ///< No-temp-var swap operation
 
@@ -106,12 +119,14 @@
 // beginning and end of I2C transfers (the Wire clock may be sped up before
 // issuing data to the display, then restored to the default rate afterward
 // so other I2C device types still work).  All of these are encapsulated
-// in the TRANSACTION_* macros.
+// in the TRANSACTION_* macros. With a bus arbiter set (see setBus()) the
+// Wire clock is left to the arbiter instead.
 
 // Check first if Wire, then hardware SPI, then soft SPI:
 #define TRANSACTION_START   \
  if(wire) {                 \
-   SETWIRECLOCK;            \
+   if(bus) bus->acquire();  \
+   else SETWIRECLOCK;       \
  } else {                   \
    if(spi) {                \
      SPI_TRANSACTION_START; \
@@ -120,7 +135,8 @@
  } ///< Wire, SPI or bitbang transfer setup
 #define TRANSACTION_END     \
  if(wire) {                 \
-   RESWIRECLOCK;            \
+   if(bus) bus->release();  \
+   else RESWIRECLOCK;       \
  } else {                   \
    SSD1306_DESELECT;        \
    if(spi) {                \
@@ -166,7 +182,8 @@
 Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi,
   int8_t rst_pin, uint32_t clkDuring, uint32_t clkAfter) :
   Adafruit_GFX(w, h), spi(NULL), wire(twi ? twi : &Wire), buffer(NULL),
-  mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1), rstPin(rst_pin)
+  shadow(NULL), bus(NULL), mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1),
+  rstPin(rst_pin)
 #if ARDUINO >= 157
   , wireClk(clkDuring), restoreClk(clkAfter)
 #endif
@@ -203,8 +220,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi,
 Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h,
   int8_t mosi_pin, int8_t sclk_pin, int8_t dc_pin, int8_t rst_pin,
   int8_t cs_pin) : Adafruit_GFX(w, h), spi(NULL), wire(NULL), buffer(NULL),
-  mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin), csPin(cs_pin),
-  rstPin(rst_pin) {
+  shadow(NULL), bus(NULL), mosiPin(mosi_pin), clkPin(sclk_pin),
+  dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
 }
 
 /*!
@@ -236,7 +253,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h,
 Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, SPIClass *spi,
   int8_t dc_pin, int8_t rst_pin, int8_t cs_pin, uint32_t bitrate) :
   Adafruit_GFX(w, h), spi(spi ? spi : &SPI), wire(NULL), buffer(NULL),
-  mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
+  shadow(NULL), bus(NULL), mosiPin(-1), clkPin(-1), dcPin(dc_pin),
+  csPin(cs_pin), rstPin(rst_pin) {
 #ifdef SPI_HAS_TRANSACTION
   spiSettings = SPISettings(bitrate, MSBFIRST, SPI_MODE0);
 #endif
@@ -271,8 +289,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, SPIClass *spi,
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t mosi_pin, int8_t sclk_pin,
   int8_t dc_pin, int8_t rst_pin, int8_t cs_pin) :
   Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(NULL), wire(NULL),
-  buffer(NULL), mosiPin(mosi_pin), clkPin(sclk_pin), dcPin(dc_pin),
-  csPin(cs_pin), rstPin(rst_pin) {
+  buffer(NULL), shadow(NULL), bus(NULL), mosiPin(mosi_pin),
+  clkPin(sclk_pin), dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
 }
 
 /*!
@@ -298,8 +316,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(int8_t mosi_pin, int8_t sclk_pin,
 */
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t dc_pin, int8_t rst_pin,
   int8_t cs_pin) : Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT),
-  spi(&SPI), wire(NULL), buffer(NULL), mosiPin(-1), clkPin(-1),
-  dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
+  spi(&SPI), wire(NULL), buffer(NULL), shadow(NULL), bus(NULL),
+  mosiPin(-1), clkPin(-1), dcPin(dc_pin), csPin(cs_pin), rstPin(rst_pin) {
 #ifdef SPI_HAS_TRANSACTION
   spiSettings = SPISettings(8000000, MSBFIRST, SPI_MODE0);
 #endif
@@ -321,8 +339,8 @@ Adafruit_SSD1306::Adafruit_SSD1306(int8_t dc_pin, int8_t rst_pin,
 */
 Adafruit_SSD1306::Adafruit_SSD1306(int8_t rst_pin) :
   Adafruit_GFX(SSD1306_LCDWIDTH, SSD1306_LCDHEIGHT), spi(NULL), wire(&Wire),
-  buffer(NULL), mosiPin(-1), clkPin(-1), dcPin(-1), csPin(-1),
-  rstPin(rst_pin) {
+  buffer(NULL), shadow(NULL), bus(NULL), mosiPin(-1), clkPin(-1),
+  dcPin(-1), csPin(-1), rstPin(rst_pin) {
 }
 
 /*!
@@ -333,6 +351,10 @@ Adafruit_SSD1306::~Adafruit_SSD1306(void) {
     free(buffer);
     buffer = NULL;
   }
+  if(shadow) {
+    free(shadow);
+    shadow = NULL;
+  }
 }
 
 // LOW-LEVEL UTILS ---------------------------------------------------------
@@ -358,6 +380,191 @@ inline void Adafruit_SSD1306::SPIwrite(uint8_t d) {
   }
 }
 
+// Record that columns x0 to x1 of pages page0 to page1 have changed since
+// the last display() call. Coordinates are raw (unrotated) and must
+// already be clipped to the display.
+inline void Adafruit_SSD1306::markDirty(uint8_t x0, uint8_t x1,
+  uint8_t page0, uint8_t page1) {
+  for(; page0 <= page1; page0++) {
+    if(x0 < dirtyMin[page0]) dirtyMin[page0] = x0;
+    if(x1 > dirtyMax[page0]) dirtyMax[page0] = x1;
+  }
+}
+
+// Flag the whole buffer for transfer on the next display() call.
+void Adafruit_SSD1306::markAllDirty(void) {
+  memset(dirtyMin, 0, sizeof(dirtyMin));
+  memset(dirtyMax, WIDTH - 1, sizeof(dirtyMax));
+}
+
+// First column from x to x1 where a and b differ, x1 + 1 if none. Whole
+// words are compared while they match.
+static uint8_t firstDiff(const uint8_t *a, const uint8_t *b, uint8_t x,
+  uint8_t x1) {
+  while(x <= x1) {
+    if((x1 - x) >= (uint8_t)(sizeof(diff_word) - 1)) {
+      diff_word wa, wb;
+      memcpy(&wa, &a[x], sizeof(wa));
+      memcpy(&wb, &b[x], sizeof(wb));
+      if(wa == wb) {
+        x += sizeof(wa);
+        continue;
+      }
+    }
+    if(a[x] != b[x]) break;
+    x++;
+  }
+  return x;
+}
+
+// First column from x to x1 where a and b match, x1 + 1 if none.
+static uint8_t firstSame(const uint8_t *a, const uint8_t *b, uint8_t x,
+  uint8_t x1) {
+  while((x <= x1) && (a[x] != b[x])) x++;
+  return x;
+}
+
+// Open a window on the next page with data to flush, taking in the pages
+// after it with the same columns. Returns false if there are none left.
+// Transaction must already be started.
+boolean Adafruit_SSD1306::flushWindow(void) {
+  uint8_t pages = (HEIGHT + 7) / 8;
+  for(;;) {
+    while((flushPage < pages) &&
+          (flushMin[flushPage] > flushMax[flushPage])) flushPage++;
+    if(flushPage >= pages) return false;
+    if(!shadow) break;
+    if(flushRun()) { // Just the changed run, on this page only
+      flushLast = flushPage;
+      ssd1306_window(flushPage, flushPage, flushMin[flushPage], flushEnd);
+      return true;
+    }
+    flushPageDone(); // Nothing on the page changed after all
+  }
+
+  uint8_t col0 = flushMin[flushPage], col1 = flushMax[flushPage];
+  flushLast = flushPage;
+  while(((flushLast + 1) < pages) && (flushMin[flushLast + 1] == col0) &&
+        (flushMax[flushLast + 1] == col1)) flushLast++;
+  flushEnd = col1;
+  ssd1306_window(flushPage, flushLast, col0, col1);
+  return true;
+}
+
+// Frame diffing: find the next run of columns on flushPage, within what
+// is left of its span, that differs from the shadow copy. Runs closer
+// together than the cost of a new window are merged into one. Sets
+// flushMin[flushPage] and flushEnd to the run; returns false if the rest
+// of the span is unchanged. On a page the shadow may not match, the rest
+// of the span is the run.
+boolean Adafruit_SSD1306::flushRun(void) {
+  if(shadowStale & (1 << flushPage)) {
+    flushEnd = flushMax[flushPage];
+    return true;
+  }
+
+  const uint8_t *now  = &buffer[flushPage * WIDTH],
+                *sent = &shadow[flushPage * WIDTH];
+  uint8_t        x1   = flushMax[flushPage],
+                 cost = wire ? WINDOW_COST_I2C : WINDOW_COST_SPI;
+
+  uint8_t x = firstDiff(now, sent, flushMin[flushPage], x1);
+  if(x > x1) return false;
+  flushMin[flushPage] = x;
+  for(;;) {
+    flushEnd = firstSame(now, sent, x, x1) - 1;
+    x = firstDiff(now, sent, flushEnd + 1, x1);
+    if((x > x1) || ((x - flushEnd - 1) >= cost)) break; // Gap costs more
+  }
+  return true;
+}
+
+// The page in flushPage has been sent; move on to the next. A page the
+// shadow did not match now does if the flush sent the whole of it.
+void Adafruit_SSD1306::flushPageDone(void) {
+  uint8_t bit = 1 << flushPage;
+  if(shadowResend & bit) {
+    shadowStale  &= ~bit;
+    shadowResend &= ~bit;
+  }
+  flushMin[flushPage] = 0xFF;
+  flushMax[flushPage] = 0;
+  flushPage++;
+}
+
+/*!
+    @brief  Keep a copy of the frame last sent, and only send the runs of
+            columns that differ from it.
+    @param  enable
+            true to allocate the copy (WIDTH * pages bytes, as much again
+            as the buffer) and compare against it, false to free it.
+    @return true on success, false if the copy could not be allocated.
+    @note   Drawing marks whole spans of columns as changed, even when it
+            leaves them as they were (e.g. redrawing the same text); with
+            this the flush compares those spans a word at a time and sends
+            only the bytes that actually changed, as one PAGEADDR/
+            COLUMNADDR window per run. Runs with a gap between them smaller
+            than the bytes a new window takes on the bus (10 on I2C, 6 on
+            SPI) are sent as one. As what is on the panel is not known
+            until then, pages are sent whole until a flush begun after
+            this call has sent the whole screen. For boards with RAM to
+            spare.
+*/
+boolean Adafruit_SSD1306::setFrameDiff(boolean enable) {
+  if(!enable) {
+    if(shadow) {
+      free(shadow);
+      shadow = NULL;
+    }
+    return true;
+  }
+  uint16_t size = WIDTH * ((HEIGHT + 7) / 8);
+  if(!buffer) return false; // begin() first
+  if((!shadow) && !(shadow = (uint8_t *)malloc(size)))
+    return false;
+  markAllDirty();
+  flushLast    = 0xFF; // Runs, not whole spans, from the next window on
+  shadowStale  = 0xFF; // Until the next flush has sent every page
+  shadowResend = 0;
+  return true;
+}
+
+#ifdef SSD1306_TWI_STREAM
+// Wait for the pages handed to the TWI stream to go out (or for the stream
+// to be paused) and mark those sent as done. If the stream failed, its
+// pages are left to the next flush rather than retried by this one.
+void Adafruit_SSD1306::flushStreamed(void) {
+  if(!flushRows) return;
+  while(wire->busy());
+  uint8_t sent = wire->rowsSent();
+  if(shadow) { // The shadow took the rows in advance, but some never went:
+    // they are still left to flush, so resend those pages whole
+    for(uint8_t page = flushPage + sent; page <= flushLast; page++) {
+      shadowStale  |= 1 << page;
+      shadowResend |= 1 << page;
+    }
+  }
+  for(; sent; sent--) {
+    if(flushEnd < flushMax[flushPage]) { // Run sent, rest of page to go
+      flushMin[flushPage] = flushEnd + 1;
+      flushLast = 0xFF;
+      break;
+    }
+    flushPageDone();
+  }
+  if(!wire->rowsSent()) { // Failed (a paused stream sends a row at least)
+    for(; flushPage <= flushLast; flushPage++) {
+      markDirty(flushMin[flushPage], flushMax[flushPage], flushPage,
+        flushPage);
+      flushMin[flushPage] = 0xFF;
+      flushMax[flushPage] = 0;
+    }
+  }
+  if(flushPage > flushLast) flushLast = 0xFF; // Window finished
+  flushRows = 0;
+}
+#endif
+
 // Issue single command to SSD1306, using I2C or hard/soft SPI as needed.
 // Because command calls are often grouped, SPI transaction and selection
 // must be started/ended in calling function for efficiency.
@@ -398,6 +605,49 @@ void Adafruit_SSD1306::ssd1306_commandList(const uint8_t *c, uint8_t n) {
   }
 }
 
+// Set the GDDRAM write window to pages page0 to page1, columns col0 to
+// col1, same rules as above re: transactions. On I2C this is a single
+// transfer rather than six separate ssd1306_command1() calls.
+// This is a private function, not exposed.
+void Adafruit_SSD1306::ssd1306_window(uint8_t page0, uint8_t page1,
+  uint8_t col0, uint8_t col1) {
+  uint8_t cmd[] = { SSD1306_PAGEADDR, page0, page1,
+                    SSD1306_COLUMNADDR, col0, col1 };
+  if(wire) { // I2C
+    wire->beginTransmission(i2caddr);
+    WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
+    for(uint8_t i=0; i<sizeof(cmd); i++) WIRE_WRITE(cmd[i]);
+    wire->endTransmission();
+  } else { // SPI -- transaction started in calling function
+    SSD1306_MODE_COMMAND
+    for(uint8_t i=0; i<sizeof(cmd); i++) SPIwrite(cmd[i]);
+  }
+}
+
+// Issue 'count' bytes of GDDRAM data, same rules as above re: transactions.
+// On I2C the data is split into Wire-buffer-sized transfers.
+void Adafruit_SSD1306::ssd1306_data(const uint8_t *ptr, uint16_t count) {
+  if(wire) { // I2C
+    wire->beginTransmission(i2caddr);
+    WIRE_WRITE((uint8_t)0x40);
+    uint8_t bytesOut = 1;
+    while(count--) {
+      if(bytesOut >= WIRE_MAX) {
+        wire->endTransmission();
+        wire->beginTransmission(i2caddr);
+        WIRE_WRITE((uint8_t)0x40);
+        bytesOut = 1;
+      }
+      WIRE_WRITE(*ptr++);
+      bytesOut++;
+    }
+    wire->endTransmission();
+  } else { // SPI -- transaction started in calling function
+    SSD1306_MODE_DATA
+    while(count--) SPIwrite(*ptr++);
+  }
+}
+
 // A public version of ssd1306_command1(), for existing user code that
 // might rely on that function. This encapsulates the command transfer
 // in a transaction start/end, similar to old library's handling of it.
@@ -414,6 +664,39 @@ void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
   TRANSACTION_END
 }
 
+/*!
+    @brief  Check the display acknowledges a transfer, by sending it a
+            no-op command at the current I2C clock.
+    @return true if it was acknowledged, or on SPI (which cannot tell).
+    @note   Used to find the fastest I2C clock the display keeps up with.
+*/
+boolean Adafruit_SSD1306::ping(void) {
+  if(!wire) return true;
+  TRANSACTION_START
+  wire->beginTransmission(i2caddr);
+  WIRE_WRITE((uint8_t)0x00); // Co = 0, D/C = 0
+  WIRE_WRITE((uint8_t)SSD1306_NOP);
+  boolean acked = (wire->endTransmission() == 0);
+  TRANSACTION_END
+  return acked;
+}
+
+/*!
+    @brief  Share the I2C bus with other devices through an arbiter.
+    @param  arbiter
+            The display's handle on the arbiter, or NULL to go back to
+            setting the Wire clock in every transfer (the default).
+    @return None (void).
+    @note   Once set, each transfer takes the bus from the arbiter, which
+            sets the clock for it, and a flushStep() gives way between
+            chunks as soon as the arbiter reports a more urgent device
+            waiting. Set before begin() for the init sequence to go through
+            it too.
+*/
+void Adafruit_SSD1306::setBus(SSD1306_BusArbiter *arbiter) {
+  bus = arbiter;
+}
+
 // ALLOCATE & INIT DISPLAY -------------------------------------------------
 
 /*!
@@ -457,6 +740,14 @@ boolean Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, boolean reset,
   if((!buffer) && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
     return false;
 
+  memset(flushMin, 0xFF, sizeof(flushMin)); // No flush in progress
+  memset(flushMax, 0, sizeof(flushMax));
+  flushPage = 0;
+  flushLast = 0xFF;
+#ifdef SSD1306_TWI_STREAM
+  flushRows = 0;
+#endif
+
   clearDisplay();
   if(HEIGHT > 32) {
     drawBitmap((WIDTH - splash1_width) / 2, (HEIGHT - splash1_height) / 2,
@@ -466,6 +757,16 @@ boolean Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, boolean reset,
       splash2_data, splash2_width, splash2_height, 1);
   }
 
+  ssd1306_begin(vcs, addr, reset, periphBegin);
+
+  return true; // Success
+}
+
+// Initialize peripherals and pins and send the SSD1306 init sequence;
+// arguments as for begin(). Shared by begin() implementations that
+// allocate the image buffer differently.
+void Adafruit_SSD1306::ssd1306_begin(uint8_t vcs, uint8_t addr,
+  boolean reset, boolean periphBegin) {
   vccstate = vcs;
 
   // Setup pin directions
@@ -576,8 +877,6 @@ boolean Adafruit_SSD1306::begin(uint8_t vcs, uint8_t addr, boolean reset,
   ssd1306_commandList(init5, sizeof(init5));
 
   TRANSACTION_END
-
-  return true; // Success
 }
 
 // DRAWING FUNCTIONS -------------------------------------------------------
@@ -614,6 +913,7 @@ void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
       y = HEIGHT - y - 1;
       break;
     }
+    markDirty(x, x, y / 8, y / 8);
     switch(color) {
      case SSD1306_WHITE:   buffer[x + (y/8)*WIDTH] |=  (1 << (y&7)); break;
      case SSD1306_BLACK:   buffer[x + (y/8)*WIDTH] &= ~(1 << (y&7)); break;
@@ -631,6 +931,7 @@ void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
 */
 void Adafruit_SSD1306::clearDisplay(void) {
   memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+  markAllDirty();
 }
 
 /*!
@@ -691,6 +992,7 @@ void Adafruit_SSD1306::drawFastHLineInternal(
       w = (WIDTH - x);
     }
     if(w > 0) { // Proceed only if width is positive
+      markDirty(x, x + w - 1, y / 8, y / 8);
       uint8_t *pBuf = &buffer[(y / 8) * WIDTH + x],
                mask = 1 << (y & 7);
       switch(color) {
@@ -760,6 +1062,7 @@ void Adafruit_SSD1306::drawFastVLineInternal(
       __h = (HEIGHT - __y);
     }
     if(__h > 0) { // Proceed only if height is now positive
+      markDirty(x, x, __y / 8, (__y + __h - 1) / 8);
       // this display doesn't need ints for coordinates,
       // use local byte registers for faster juggling
       uint8_t  y = __y, h = __h;
@@ -831,6 +1134,255 @@ void Adafruit_SSD1306::drawFastVLineInternal(
   } // endif x in bounds
 }
 
+/*!
+    @brief  Draw a filled rectangle. This is also invoked by the
+            Adafruit_GFX library for fillScreen() and, through
+            writeFillRect(), for scaled text.
+    @param  x
+            Leftmost column -- 0 at left to (screen width - 1) at right.
+    @param  y
+            Topmost row -- 0 at top to (screen height - 1) at bottom.
+    @param  w
+            Width of rectangle, in pixels.
+    @param  h
+            Height of rectangle, in pixels.
+    @param  color
+            Fill color, one of: SSD1306_BLACK, SSD1306_WHITE or SSD1306_INVERT.
+    @return None (void).
+    @note   Changes buffer contents only, no immediate effect on display.
+            Follow up with a call to display(), or with other graphics
+            commands as needed by one's own application.
+*/
+void Adafruit_SSD1306::fillRect(
+  int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  int16_t t;
+  switch(rotation) {
+   case 1:
+    // 90 degree rotation, swap x & y and w & h, then invert x
+    t = x;
+    x = WIDTH - y - h;
+    y = t;
+    ssd1306_swap(w, h);
+    break;
+   case 2:
+    // 180 degree rotation, invert x and y
+    x = WIDTH  - x - w;
+    y = HEIGHT - y - h;
+    break;
+   case 3:
+    // 270 degree rotation, swap x & y and w & h, then invert y
+    t = x;
+    x = y;
+    y = HEIGHT - t - w;
+    ssd1306_swap(w, h);
+    break;
+  }
+  fillRectInternal(x, y, w, h, color);
+}
+
+// Fill page by page: whole 8-row bytes with memset(), masked bytes only
+// on the partial top and bottom pages.
+void Adafruit_SSD1306::fillRectInternal(
+  int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+
+  if(x < 0) { // Clip left
+    w += x;
+    x  = 0;
+  }
+  if(y < 0) { // Clip top
+    h += y;
+    y  = 0;
+  }
+  if((x + w) > WIDTH)  w = WIDTH  - x; // Clip right
+  if((y + h) > HEIGHT) h = HEIGHT - y; // Clip bottom
+  if((w <= 0) || (h <= 0)) return;
+
+  uint8_t  y1    = y + h - 1,
+           page0 = y / 8,
+           page1 = y1 / 8;
+  uint8_t *pBuf  = &buffer[page0 * WIDTH + x];
+  markDirty(x, x + w - 1, page0, page1);
+
+  for(uint8_t page = page0; page <= page1; page++, pBuf += WIDTH) {
+    uint8_t mask = 0xFF;
+    if(page == page0) mask &= 0xFF << (y  & 7);
+    if(page == page1) mask &= 0xFF >> (7 - (y1 & 7));
+
+    uint8_t *p = pBuf;
+    int16_t  n = w;
+    switch(color) {
+     case SSD1306_WHITE:
+      if(mask == 0xFF) memset(pBuf, 0xFF, w);
+      else             while(n--) *p++ |= mask;
+      break;
+     case SSD1306_BLACK:
+      if(mask == 0xFF) memset(pBuf, 0x00, w);
+      else { mask = ~mask; while(n--) *p++ &= mask; }
+      break;
+     case SSD1306_INVERSE:
+      while(n--) *p++ ^= mask;
+      break;
+    }
+  }
+}
+
+/*!
+    @brief  Draw a single character of the built-in 'classic' 5x7 font.
+            Unrotated glyphs that fit entirely on screen at text size 1-3
+            are written straight into the buffer one byte column at a
+            time; anything else (custom fonts, rotation, clipping, larger
+            sizes) is handed to Adafruit_GFX.
+    @param  x
+            Left edge of the 6x8 character cell.
+    @param  y
+            Top edge of the 6x8 character cell.
+    @param  c
+            Character to draw.
+    @param  color
+            Foreground color, one of: SSD1306_BLACK, SSD1306_WHITE or
+            SSD1306_INVERT.
+    @param  bg
+            Background color; when equal to color the background is left
+            untouched (transparent text).
+    @param  size
+            Magnification factor, 1 = 6x8 pixel cell.
+    @return None (void).
+    @note   Changes buffer contents only, no immediate effect on display.
+            Follow up with a call to display(), or with other graphics
+            commands as needed by one's own application.
+*/
+void Adafruit_SSD1306::drawChar(int16_t x, int16_t y, unsigned char c,
+  uint16_t color, uint16_t bg, uint8_t size) {
+  boolean opaque = (bg != color);
+  if(gfxFont || rotation || !size || (size > 3) || (x < 0) || (y < 0) ||
+     ((x + 6 * size) > WIDTH) || ((y + 8 * size) > HEIGHT) ||
+     (color > SSD1306_INVERSE) ||
+     (opaque && ((color > SSD1306_WHITE) || (bg > SSD1306_WHITE)))) {
+    Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+    return;
+  }
+
+  if(!_cp437 && (c >= 176)) c++; // Handle 'classic' charset behavior
+
+  // Bit doubling of a nibble, for size 2 glyph columns
+  static const uint8_t PROGMEM doubled[16] = {
+    0x00, 0x03, 0x0C, 0x0F, 0x30, 0x33, 0x3C, 0x3F,
+    0xC0, 0xC3, 0xCC, 0xCF, 0xF0, 0xF3, 0xFC, 0xFF };
+
+  const uint8_t *glyph = classicGlyph(c);
+  uint8_t  shift = y & 7, page0 = y / 8, rows = 8 * size,
+           pages = (shift + rows + 7) / 8;
+  uint32_t cover = ((1UL << rows) - 1) << shift; // Cell rows, page-relative
+  uint8_t *pCol  = &buffer[page0 * WIDTH + x];
+
+  // Transparent text leaves the blank spacing column untouched
+  markDirty(x, x + (opaque ? 6 : 5) * size - 1, page0, page0 + pages - 1);
+
+  for(int8_t i=0; i<6; i++) { // 5 glyph columns plus blank spacing
+    uint8_t  line = (i < 5) ? pgm_read_byte(&glyph[i]) : 0;
+    uint32_t bits;
+    if(size == 1) {
+      bits = line;
+    } else if(size == 2) {
+      bits = pgm_read_byte(&doubled[line & 0x0F]) |
+        ((uint16_t)pgm_read_byte(&doubled[line >> 4]) << 8);
+    } else {
+      bits = 0;
+      for(int8_t j=0; j<8; j++, line >>= 1) {
+        if(line & 1) bits |= 7UL << (3 * j);
+      }
+    }
+    bits <<= shift;
+    if(!bits && !opaque) { // Nothing to draw in transparent mode
+      pCol += size;
+      continue;
+    }
+
+    for(uint8_t s=0; s<size; s++, pCol++) {
+      uint8_t *pBuf = pCol;
+      if((pages == 1) && !opaque) { // Single page: OR, clear or flip
+        switch(color) {
+         case SSD1306_WHITE:   *pBuf |=  (uint8_t)bits; break;
+         case SSD1306_BLACK:   *pBuf &= ~(uint8_t)bits; break;
+         case SSD1306_INVERSE: *pBuf ^=  (uint8_t)bits; break;
+        }
+        continue;
+      }
+      // Spread the column over the pages it covers, masking the cell's
+      // first and last page when y is not page-aligned
+      for(uint8_t p=0; p<pages; p++, pBuf += WIDTH) {
+        uint8_t b = bits >> (8 * p), mask = cover >> (8 * p);
+        if(opaque) {
+          if(color == SSD1306_BLACK) b = ~b & mask;
+          *pBuf = (*pBuf & ~mask) | b;
+        } else {
+          switch(color) {
+           case SSD1306_WHITE:   *pBuf |=  b; break;
+           case SSD1306_BLACK:   *pBuf &= ~b; break;
+           case SSD1306_INVERSE: *pBuf ^=  b; break;
+          }
+        }
+      }
+    }
+  }
+}
+
+/*!
+    @brief  Copy a pre-rendered, page-aligned bitmap from PROGMEM into the
+            display buffer, e.g. text labels generated by
+            scripts/make_labels.py. The bitmap uses the SSD1306's own
+            page-major layout: w bytes for each 8-row page, one byte being
+            8 vertical pixels with the LSB at the top.
+    @param  x
+            Leftmost column -- 0 at left to (screen width - 1) at right.
+    @param  page
+            First 8-row page -- 0 at top to (screen height / 8 - 1).
+    @param  bitmap
+            Bitmap data in PROGMEM, pages * w bytes.
+    @param  w
+            Width of bitmap, in pixels.
+    @param  pages
+            Height of bitmap, in 8-row pages.
+    @return None (void).
+    @note   Set pixels are drawn SSD1306_WHITE and clear ones
+            SSD1306_BLACK. Unrotated, each page is a single memcpy_P();
+            with rotation the bitmap is plotted pixel by pixel.
+            Changes buffer contents only, no immediate effect on display.
+            Follow up with a call to display(), or with other graphics
+            commands as needed by one's own application.
+*/
+void Adafruit_SSD1306::drawPageBitmap(int16_t x, uint8_t page,
+  const uint8_t *bitmap, uint8_t w, uint8_t pages) {
+  if(rotation) {
+    for(uint8_t p=0; p<pages; p++) {
+      for(uint8_t i=0; i<w; i++) {
+        uint8_t b = pgm_read_byte(&bitmap[p * w + i]);
+        for(uint8_t j=0; j<8; j++, b >>= 1)
+          drawPixel(x + i, (page + p) * 8 + j,
+            (b & 1) ? SSD1306_WHITE : SSD1306_BLACK);
+      }
+    }
+    return;
+  }
+
+  uint8_t skip = 0, maxPages = (HEIGHT + 7) / 8;
+  if(x < 0) {
+    if(-x >= w) return;
+    skip = -x;
+    x    = 0;
+  }
+  if((x >= WIDTH) || (page >= maxPages)) return;
+  uint8_t n = w - skip;
+  if((x + n) > WIDTH) n = WIDTH - x;
+  if((page + pages) > maxPages) pages = maxPages - page;
+
+  markDirty(x, x + n - 1, page, page + pages - 1);
+  for(uint8_t *pBuf = &buffer[page * WIDTH + x]; pages--; pBuf += WIDTH) {
+    memcpy_P(pBuf, bitmap + skip, n);
+    bitmap += w;
+  }
+}
+
 /*!
     @brief  Return color of a single pixel in display buffer.
     @param  x
@@ -868,8 +1420,11 @@ boolean Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
     @brief  Get base address of display buffer for direct reading or writing.
     @return Pointer to an unsigned 8-bit array, column-major, columns padded
             to full byte boundary if needed.
+    @note   Changes made through this pointer can't be tracked, so the
+            next display() call transfers the whole buffer.
 */
 uint8_t *Adafruit_SSD1306::getBuffer(void) {
+  markAllDirty();
   return buffer;
 }
 
@@ -881,18 +1436,15 @@ uint8_t *Adafruit_SSD1306::getBuffer(void) {
     @note   Drawing operations are not visible until this function is
             called. Call after each graphics command, or after a whole set
             of graphics commands, as best needed by one's own application.
+            Only the pages and columns changed since the previous call are
+            transferred, each page as its own PAGEADDR/COLUMNADDR window
+            (consecutive pages with the same column span share a window);
+            with setFrameDiff(), only the runs of those columns that
+            differ from what was last sent. This blocks until the transfer
+            is complete; see beginFlush() and flushStep() for an
+            incremental alternative.
 */
 void Adafruit_SSD1306::display(void) {
-  TRANSACTION_START
-  static const uint8_t PROGMEM dlist1[] = {
-    SSD1306_PAGEADDR,
-    0,                         // Page start address
-    0xFF,                      // Page end (not really, but works here)
-    SSD1306_COLUMNADDR,
-    0 };                       // Column start address
-  ssd1306_commandList(dlist1, sizeof(dlist1));
-  ssd1306_command1(WIDTH - 1); // Column end address
-
 #if defined(ESP8266)
   // ESP8266 needs a periodic yield() call to avoid watchdog reset.
   // With the limited size of SSD1306 displays, and the fast bitrate
@@ -902,31 +1454,214 @@ void Adafruit_SSD1306::display(void) {
   // 32-byte transfer condition below.
   yield();
 #endif
-  uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
-  uint8_t *ptr   = buffer;
-  if(wire) { // I2C
-    wire->beginTransmission(i2caddr);
-    WIRE_WRITE((uint8_t)0x40);
-    uint8_t bytesOut = 1;
-    while(count--) {
-      if(bytesOut >= WIRE_MAX) {
-        wire->endTransmission();
-        wire->beginTransmission(i2caddr);
-        WIRE_WRITE((uint8_t)0x40);
-        bytesOut = 1;
-      }
-      WIRE_WRITE(*ptr++);
-      bytesOut++;
+  beginFlush();
+  while(!flushStep(0xFFFFFFFFUL));
+#if defined(ESP8266)
+  yield();
+#endif
+}
+
+/*!
+    @brief  Push a rectangle of the data in RAM to the SSD1306 display
+            now, whether or not it has changed.
+    @param  x
+            Leftmost column -- 0 at left to (screen width - 1) at right.
+    @param  y
+            Topmost row -- 0 at top to (screen height - 1) at bottom.
+    @param  w
+            Width of rectangle, in pixels.
+    @param  h
+            Height of rectangle, in pixels.
+    @return None (void).
+    @note   The rectangle is rotated as drawing is, then widened to whole
+            8-row pages and sent as a single PAGEADDR/COLUMNADDR window,
+            so a screen laid out in fixed zones can send each on its own.
+            Changes inside it no longer wait for display() or
+            beginFlush(). A flush in progress is resumed by the next
+            flushStep(). Blocks until the transfer is complete.
+*/
+void Adafruit_SSD1306::displayRegion(int16_t x, int16_t y, int16_t w,
+  int16_t h) {
+  int16_t t;
+  switch(rotation) {
+   case 1:
+    t = x;
+    x = WIDTH - y - h;
+    y = t;
+    ssd1306_swap(w, h);
+    break;
+   case 2:
+    x = WIDTH  - x - w;
+    y = HEIGHT - y - h;
+    break;
+   case 3:
+    t = x;
+    x = y;
+    y = HEIGHT - t - w;
+    ssd1306_swap(w, h);
+    break;
+  }
+  if(x < 0) { w += x; x = 0; }
+  if(y < 0) { h += y; y = 0; }
+  if((x + w) > WIDTH)  w = WIDTH  - x;
+  if((y + h) > HEIGHT) h = HEIGHT - y;
+  if((w <= 0) || (h <= 0)) return;
+
+  uint8_t x0 = x, x1 = x + w - 1, page0 = y / 8, page1 = (y + h - 1) / 8;
+
+  TRANSACTION_START
+#ifdef SSD1306_TWI_STREAM
+  flushStreamed();
+#endif
+  flushLast = 0xFF; // Moving the RAM pointer closes any open window
+  ssd1306_window(page0, page1, x0, x1);
+  for(uint8_t page = page0; page <= page1; page++) {
+    uint16_t i = page * WIDTH + x0;
+    ssd1306_data(&buffer[i], w);
+    if(shadow) memcpy(&shadow[i], &buffer[i], w);
+
+    // Trim what was sent off the page's changes
+    if((dirtyMin[page] >= x0) && (dirtyMin[page] <= x1))
+      dirtyMin[page] = x1 + 1;
+    if((dirtyMax[page] >= x0) && (dirtyMax[page] <= x1))
+      dirtyMax[page] = x0 - 1;
+    if((dirtyMin[page] > dirtyMax[page]) || (dirtyMax[page] >= WIDTH)) {
+      dirtyMin[page] = 0xFF;
+      dirtyMax[page] = 0;
     }
-    wire->endTransmission();
-  } else { // SPI
-    SSD1306_MODE_DATA
-    while(count--) SPIwrite(*ptr++);
   }
   TRANSACTION_END
-#if defined(ESP8266)
-  yield();
+}
+
+/*!
+    @brief  Start an incremental transfer of the data currently in RAM to
+            the SSD1306 display. Nothing is sent until flushStep() is
+            called.
+    @return None (void).
+    @note   The changes made since the last flush are captured now;
+            drawing may continue while the transfer is in progress and
+            will go out with the next flush. If a previous flush has not
+            finished, whatever it had left to send is carried into this
+            one.
+*/
+void Adafruit_SSD1306::beginFlush(void) {
+  uint8_t pages = (HEIGHT + 7) / 8;
+#ifdef SSD1306_TWI_STREAM
+  flushStreamed();
+#endif
+  for(uint8_t page = 0; page < pages; page++) {
+    if(flushMin[page] <= flushMax[page]) // Left over from unfinished flush
+      markDirty(flushMin[page], flushMax[page], page, page);
+    flushMin[page] = dirtyMin[page];
+    flushMax[page] = dirtyMax[page];
+    dirtyMin[page] = 0xFF;
+    dirtyMax[page] = 0;
+  }
+  // Whatever of those pages the shadow may not match is now in the flush
+  if(shadow) shadowResend = shadowStale;
+  flushPage = 0;
+  flushLast = 0xFF;
+}
+
+/*!
+    @brief  Continue a transfer started with beginFlush(), sending data in
+            chunks of up to one Wire buffer each.
+    @param  budget_us
+            Time allowance in microseconds. At least one chunk is sent per
+            call; further chunks are sent while the time spent in this
+            call is still below the allowance and, with a bus arbiter set,
+            no more urgent device is waiting for the bus. Default if
+            unspecified is 0 (a single chunk). With SSD1306_TWI_ISR each
+            window goes out as a single I2C transfer sent from the TWI
+            interrupt instead: a call starts the next one, if the last has
+            finished, and returns once the allowance is spent (at once for
+            the default), otherwise waiting for each window to go out
+            before starting another, under the same conditions. A window
+            the display did not take is left to the next flush.
+    @return true if the transfer is complete (nothing is left to send),
+            false if flushStep() needs to be called again.
+*/
+boolean Adafruit_SSD1306::flushStep(uint32_t budget_us) {
+  uint32_t start = micros();
+  uint8_t  pages = (HEIGHT + 7) / 8;
+
+#ifdef SSD1306_TWI_STREAM
+  if(wire) { // The TWI interrupt sends each window
+    if(flushRows && wire->busy()) return false;
+    flushStreamed();
+
+    // One window at least, as one chunk on Wire: a caller looping until
+    // done (display()) must get somewhere even while preempted
+    boolean done = false;
+    TRANSACTION_START
+    for(;;) {
+      if((flushLast == 0xFF) && !flushWindow()) { // All sent
+        done = true;
+        break;
+      }
+      uint8_t *rows  = &buffer[flushPage * WIDTH + flushMin[flushPage]];
+      uint8_t  width = flushEnd - flushMin[flushPage] + 1;
+      flushRows = flushLast - flushPage + 1;
+      if(shadow) { // Send from the shadow, so it holds exactly what went
+        uint8_t *copy = &shadow[flushPage * WIDTH + flushMin[flushPage]];
+        for(uint8_t row = 0; row < flushRows; row++)
+          memcpy(&copy[row * WIDTH], &rows[row * WIDTH], width);
+        rows = copy;
+      }
+      wire->stream(i2caddr, 0x40, rows, width, WIDTH, flushRows);
+
+      // Within the allowance, wait for it and go on to the next window
+      // unless a more urgent device is waiting
+      if((micros() - start) >= budget_us) break;
+      flushStreamed();
+      if(bus && bus->preempted()) break;
+    }
+    TRANSACTION_END
+    return done;
+  }
 #endif
+
+  TRANSACTION_START
+  do {
+    if(flushLast == 0xFF) { // Open a window on the next page with data
+      if(!flushWindow()) break; // All sent
+    }
+
+    // Send one chunk, continuing across pages within the open window
+    uint8_t bytesOut = 1;
+    if(wire) { // I2C
+      wire->beginTransmission(i2caddr);
+      WIRE_WRITE((uint8_t)0x40);
+    } else { // SPI
+      SSD1306_MODE_DATA
+    }
+    while((bytesOut < WIRE_MAX) && (flushPage <= flushLast)) {
+      uint16_t i = flushPage * WIDTH + flushMin[flushPage];
+      uint8_t  d = buffer[i];
+      if(wire) WIRE_WRITE(d);
+      else     SPIwrite(d);
+      if(shadow) shadow[i] = d;
+      bytesOut++;
+      if(flushMin[flushPage] < flushEnd) {
+        flushMin[flushPage]++;
+      } else if(flushEnd < flushMax[flushPage]) { // Run sent, rest to go
+        flushMin[flushPage] = flushEnd + 1;
+        flushLast = 0xFF;
+        break;
+      } else { // Page finished
+        flushPageDone();
+      }
+    }
+    if(wire) wire->endTransmission();
+    if(flushPage > flushLast) flushLast = 0xFF; // Window finished
+  } while(((micros() - start) < budget_us) && !(bus && bus->preempted()));
+  TRANSACTION_END
+
+  if(flushLast == 0xFF) { // Skip ahead so completion is reported promptly
+    while((flushPage < pages) &&
+          (flushMin[flushPage] > flushMax[flushPage])) flushPage++;
+  }
+  return flushPage >= pages;
 }
 
 // SCROLLING FUNCTIONS -----------------------------------------------------
@@ -1051,6 +1786,7 @@ void Adafruit_SSD1306::stopscroll(void) {
   TRANSACTION_START
   ssd1306_command1(SSD1306_DEACTIVATE_SCROLL);
   TRANSACTION_END
+  markAllDirty(); // Scrolling moved the display RAM contents
 }
 
 // OTHER HARDWARE SETTINGS -------------------------------------------------
@@ -1090,3 +1826,251 @@ void Adafruit_SSD1306::dim(boolean dim) {
   ssd1306_command1(dim ? 0 : contrast);
   TRANSACTION_END
 }
+
+// STRIP (PAGE-AT-A-TIME) RENDERING ----------------------------------------
+
+/*!
+    @brief  Constructor for I2C-interfaced SSD1306 displays rendered one
+            page at a time. Arguments are as for the Adafruit_SSD1306 I2C
+            constructor.
+    @return Adafruit_SSD1306_Strip object.
+    @note   Call the object's begin() function before use -- buffer
+            allocation is performed there!
+*/
+Adafruit_SSD1306_Strip::Adafruit_SSD1306_Strip(uint8_t w, uint8_t h,
+  TwoWire *twi, int8_t rst_pin, uint32_t clkDuring, uint32_t clkAfter) :
+  Adafruit_SSD1306(w, h, twi, rst_pin, clkDuring, clkAfter), renderer(NULL),
+  stripPage(0) {
+}
+
+/*!
+    @brief  Constructor for hardware SPI SSD1306 displays rendered one page
+            at a time. Arguments are as for the Adafruit_SSD1306 hardware
+            SPI constructor.
+    @return Adafruit_SSD1306_Strip object.
+    @note   Call the object's begin() function before use -- buffer
+            allocation is performed there!
+*/
+Adafruit_SSD1306_Strip::Adafruit_SSD1306_Strip(uint8_t w, uint8_t h,
+  SPIClass *spi, int8_t dc_pin, int8_t rst_pin, int8_t cs_pin,
+  uint32_t bitrate) :
+  Adafruit_SSD1306(w, h, spi, dc_pin, rst_pin, cs_pin, bitrate),
+  renderer(NULL), stripPage(0) {
+}
+
+/*!
+    @brief  Allocate RAM for a single page buffer (WIDTH bytes), initialize
+            peripherals and pins. Arguments are as for
+            Adafruit_SSD1306::begin().
+    @return true on successful allocation/init, false otherwise.
+    @note   No splash screen is drawn; the display shows whatever the
+            render callback draws on the first display() call.
+*/
+boolean Adafruit_SSD1306_Strip::begin(uint8_t vcs, uint8_t addr,
+  boolean reset, boolean periphBegin) {
+
+  if((!buffer) && !(buffer = (uint8_t *)malloc(WIDTH)))
+    return false;
+
+  memset(dirtyMin, 0xFF, sizeof(dirtyMin)); // Dirty tracking unused here
+  memset(dirtyMax, 0, sizeof(dirtyMax));
+  stripPage = (HEIGHT + 7) / 8;             // No render in progress
+  clearDisplay();
+
+  ssd1306_begin(vcs, addr, reset, periphBegin);
+
+  return true; // Success
+}
+
+/*!
+    @brief  Render and send the whole screen: there is no frame held to
+            send part of. Arguments are as for
+            Adafruit_SSD1306::displayRegion().
+    @return None (void).
+*/
+void Adafruit_SSD1306_Strip::displayRegion(int16_t x, int16_t y, int16_t w,
+  int16_t h) {
+  (void)x; (void)y; (void)w; (void)h;
+  display();
+}
+
+/*!
+    @brief  Frame diffing is not available: there is no frame held to
+            compare.
+    @param  enable
+            Ignored.
+    @return false if asked to enable it.
+*/
+boolean Adafruit_SSD1306_Strip::setFrameDiff(boolean enable) {
+  return !enable;
+}
+
+/*!
+    @brief  Set the function that draws the screen contents.
+    @param  cb
+            Render callback. It is called once per page by display() (or
+            flushStep()) and must draw the complete screen each time --
+            including setting the text cursor -- as only the rows of the
+            current page are kept.
+    @return None (void).
+*/
+void Adafruit_SSD1306_Strip::setRenderer(RenderCallback cb) {
+  renderer = cb;
+}
+
+/*!
+    @brief  Start an incremental page-by-page render and transfer. Nothing
+            is drawn or sent until flushStep() is called.
+    @return None (void).
+*/
+void Adafruit_SSD1306_Strip::beginFlush(void) {
+  stripPage = 0;
+}
+
+/*!
+    @brief  Render and send the next page(s) of a transfer started with
+            beginFlush().
+    @param  budget_us
+            Time allowance in microseconds. At least one page is rendered
+            and sent per call; further pages are done while the time spent
+            in this call is still below the allowance. Default if
+            unspecified is 0 (a single page).
+    @return true if every page has been sent, false if flushStep() needs
+            to be called again.
+*/
+boolean Adafruit_SSD1306_Strip::flushStep(uint32_t budget_us) {
+  uint32_t start = micros();
+  uint8_t  pages = (HEIGHT + 7) / 8;
+
+  while(stripPage < pages) {
+    memset(buffer, 0, WIDTH);
+    if(renderer) renderer(*this);
+
+    TRANSACTION_START
+    ssd1306_window(stripPage, stripPage, 0, WIDTH - 1);
+    ssd1306_data(buffer, WIDTH);
+    TRANSACTION_END
+
+    stripPage++;
+    if((micros() - start) >= budget_us) break;
+  }
+  return stripPage >= pages;
+}
+
+/*!
+    @brief  Clear contents of the page buffer (set all pixels to off).
+    @return None (void).
+    @note   The buffer is cleared before each page is rendered, so render
+            callbacks do not need to call this.
+*/
+void Adafruit_SSD1306_Strip::clearDisplay(void) {
+  memset(buffer, 0, WIDTH);
+}
+
+/*!
+    @brief  Set/clear/invert a single pixel if it lies in the page being
+            rendered. Arguments as for Adafruit_SSD1306::drawPixel().
+    @return None (void).
+*/
+void Adafruit_SSD1306_Strip::drawPixel(int16_t x, int16_t y,
+  uint16_t color) {
+  if((x >= 0) && (x < width()) && (y >= 0) && (y < height())) {
+    // Pixel is in-bounds. Rotate coordinates if needed.
+    switch(getRotation()) {
+     case 1:
+      ssd1306_swap(x, y);
+      x = WIDTH - x - 1;
+      break;
+     case 2:
+      x = WIDTH  - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+     case 3:
+      ssd1306_swap(x, y);
+      y = HEIGHT - y - 1;
+      break;
+    }
+    if((y / 8) != stripPage) return; // Not in this strip
+    switch(color) {
+     case SSD1306_WHITE:   buffer[x] |=  (1 << (y&7)); break;
+     case SSD1306_BLACK:   buffer[x] &= ~(1 << (y&7)); break;
+     case SSD1306_INVERSE: buffer[x] ^=  (1 << (y&7)); break;
+    }
+  }
+}
+
+/*!
+    @brief  Return color of a single pixel in the page being rendered.
+            Arguments as for Adafruit_SSD1306::getPixel().
+    @return true if pixel is set, false if clear or not in the current
+            page.
+*/
+boolean Adafruit_SSD1306_Strip::getPixel(int16_t x, int16_t y) {
+  if((x >= 0) && (x < width()) && (y >= 0) && (y < height())) {
+    // Pixel is in-bounds. Rotate coordinates if needed.
+    switch(getRotation()) {
+     case 1:
+      ssd1306_swap(x, y);
+      x = WIDTH - x - 1;
+      break;
+     case 2:
+      x = WIDTH  - x - 1;
+      y = HEIGHT - y - 1;
+      break;
+     case 3:
+      ssd1306_swap(x, y);
+      y = HEIGHT - y - 1;
+      break;
+    }
+    if((y / 8) == stripPage) return (buffer[x] & (1 << (y & 7)));
+  }
+  return false; // Pixel out of bounds or not in this strip
+}
+
+// The byte-column text path writes to the full-size buffer layout;
+// go through the clipped pixel/rect primitives instead.
+void Adafruit_SSD1306_Strip::drawChar(int16_t x, int16_t y,
+  unsigned char c, uint16_t color, uint16_t bg, uint8_t size) {
+  Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+}
+
+// Only the part of the bitmap on the current page is copied.
+void Adafruit_SSD1306_Strip::drawPageBitmap(int16_t x, uint8_t page,
+  const uint8_t *bitmap, uint8_t w, uint8_t pages) {
+  if(rotation) { // Plotted through drawPixel(), which clips to the page
+    Adafruit_SSD1306::drawPageBitmap(x, page, bitmap, w, pages);
+  } else if((stripPage >= page) && (stripPage < (page + pages))) {
+    Adafruit_SSD1306::drawPageBitmap(x, 0, bitmap + (stripPage - page) * w,
+      w, 1);
+  }
+}
+
+// Raw-coordinate line drawing, clipped to the current page and shifted
+// so the base class writes into the single page buffer.
+void Adafruit_SSD1306_Strip::drawFastHLineInternal(
+  int16_t x, int16_t y, int16_t w, uint16_t color) {
+  if((y < 0) || ((y / 8) != stripPage)) return;
+  Adafruit_SSD1306::drawFastHLineInternal(x, y & 7, w, color);
+}
+
+void Adafruit_SSD1306_Strip::drawFastVLineInternal(
+  int16_t x, int16_t y, int16_t h, uint16_t color) {
+  int16_t top = stripPage * 8, bottom = top + 8;
+  if(y < top) {
+    h -= top - y;
+    y  = top;
+  }
+  if((y + h) > bottom) h = bottom - y;
+  if(h > 0) Adafruit_SSD1306::drawFastVLineInternal(x, y - top, h, color);
+}
+
+void Adafruit_SSD1306_Strip::fillRectInternal(
+  int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+  int16_t top = stripPage * 8, bottom = top + 8;
+  if(y < top) {
+    h -= top - y;
+    y  = top;
+  }
+  if((y + h) > bottom) h = bottom - y;
+  if(h > 0) Adafruit_SSD1306::fillRectInternal(x, y - top, w, h, color);
+}
@@ -32,11 +32,21 @@
 // (NEW CODE SHOULD IGNORE THIS, USE THE CONSTRUCTORS THAT ACCEPT WIDTH
 // AND HEIGHT ARGUMENTS).
 
+// On AVR, uncomment to send the display buffer from the TWI interrupt
+// (see SSD1306_TWI.h). This replaces the Wire library, which must then
+// not be included anywhere in the sketch.
+//#define SSD1306_TWI_ISR
+
 #if defined(ARDUINO_STM32_FEATHER)
   typedef class HardwareSPI SPIClass;
 #endif
 
-#include <Wire.h>
+#if defined(SSD1306_TWI_ISR) && defined(__AVR__)
+ #define SSD1306_TWI_STREAM ///< flushStep() streams under interrupts
+ #include "SSD1306_TWI.h"
+#else
+ #include <Wire.h>
+#endif
 #include <SPI.h>
 #include <Adafruit_GFX.h>
 
@@ -87,11 +97,14 @@
 #define SSD1306_SETPRECHARGE        0xD9 ///< See datasheet
 #define SSD1306_SETCOMPINS          0xDA ///< See datasheet
 #define SSD1306_SETVCOMDETECT       0xDB ///< See datasheet
+#define SSD1306_NOP                 0xE3 ///< See datasheet
 
 #define SSD1306_SETLOWCOLUMN        0x00 ///< Not currently used
 #define SSD1306_SETHIGHCOLUMN       0x10 ///< Not currently used
 #define SSD1306_SETSTARTLINE        0x40 ///< See datasheet
 
+#define SSD1306_MAXPAGES            8    ///< 64 rows of 8 pixels, max. height
+
 #define SSD1306_EXTERNALVCC         0x01 ///< External display voltage source
 #define SSD1306_SWITCHCAPVCC        0x02 ///< Gen. display voltage from 3.3V
 
@@ -117,6 +130,20 @@
  #define SSD1306_LCDHEIGHT  16 ///< DEPRECATED: height w/SSD1306_96_16 defined
 #endif
 
+/*!
+    @brief  A display's handle on an arbiter for an I2C bus it shares with
+            other devices (see Adafruit_SSD1306::setBus()).
+*/
+class SSD1306_BusArbiter {
+ public:
+  /// Take the bus for a transfer, at the display's clock
+  virtual void    acquire(void) = 0;
+  /// Give the bus back
+  virtual void    release(void) = 0;
+  /// True if a more urgent device is waiting for the bus
+  virtual boolean preempted(void) = 0;
+};
+
 /*!
     @brief  Class that stores state and functions for interacting with
             SSD1306 OLED displays.
@@ -143,33 +170,63 @@ class Adafruit_SSD1306 : public Adafruit_GFX {
                  uint8_t i2caddr=0, boolean reset=true,
                  boolean periphBegin=true);
   void         display(void);
-  void         clearDisplay(void);
+  virtual void displayRegion(int16_t x, int16_t y, int16_t w, int16_t h);
+  virtual boolean setFrameDiff(boolean enable);
+  virtual void beginFlush(void);
+  virtual boolean flushStep(uint32_t budget_us=0);
+  virtual void clearDisplay(void);
   void         invertDisplay(boolean i);
   void         dim(boolean dim);
   void         drawPixel(int16_t x, int16_t y, uint16_t color);
   virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
   virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+  virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h,
+                 uint16_t color);
+  virtual void drawChar(int16_t x, int16_t y, unsigned char c,
+                 uint16_t color, uint16_t bg, uint8_t size);
+  virtual void drawPageBitmap(int16_t x, uint8_t page, const uint8_t *bitmap,
+                 uint8_t w, uint8_t pages);
   void         startscrollright(uint8_t start, uint8_t stop);
   void         startscrollleft(uint8_t start, uint8_t stop);
   void         startscrolldiagright(uint8_t start, uint8_t stop);
   void         startscrolldiagleft(uint8_t start, uint8_t stop);
   void         stopscroll(void);
   void         ssd1306_command(uint8_t c);
-  boolean      getPixel(int16_t x, int16_t y);
+  boolean      ping(void);
+  void         setBus(SSD1306_BusArbiter *arbiter);
+  virtual boolean getPixel(int16_t x, int16_t y);
   uint8_t     *getBuffer(void);
 
- private:
+ protected:
   inline void  SPIwrite(uint8_t d) __attribute__((always_inline));
-  void         drawFastHLineInternal(int16_t x, int16_t y, int16_t w,
+  virtual void drawFastHLineInternal(int16_t x, int16_t y, int16_t w,
                  uint16_t color);
-  void         drawFastVLineInternal(int16_t x, int16_t y, int16_t h,
+  virtual void drawFastVLineInternal(int16_t x, int16_t y, int16_t h,
                  uint16_t color);
+  virtual void fillRectInternal(int16_t x, int16_t y, int16_t w, int16_t h,
+                 uint16_t color);
+  void         ssd1306_begin(uint8_t vcs, uint8_t addr, boolean reset,
+                 boolean periphBegin);
   void         ssd1306_command1(uint8_t c);
   void         ssd1306_commandList(const uint8_t *c, uint8_t n);
+  void         ssd1306_window(uint8_t page0, uint8_t page1, uint8_t col0,
+                 uint8_t col1);
+  void         ssd1306_data(const uint8_t *ptr, uint16_t count);
+  inline void  markDirty(uint8_t x0, uint8_t x1, uint8_t page0,
+                 uint8_t page1) __attribute__((always_inline));
+  void         markAllDirty(void);
+  boolean      flushWindow(void);
+  boolean      flushRun(void);
+  void         flushPageDone(void);
+#ifdef SSD1306_TWI_STREAM
+  void         flushStreamed(void);
+#endif
 
   SPIClass    *spi;
   TwoWire     *wire;
   uint8_t     *buffer;
+  uint8_t     *shadow;  // Frame as last sent, NULL unless setFrameDiff()
+  SSD1306_BusArbiter *bus; // Shared I2C bus arbiter, NULL if none
   int8_t       i2caddr, vccstate, page_end;
   int8_t       mosiPin    ,  clkPin    ,  dcPin    ,  csPin, rstPin;
 #ifdef HAVE_PORTREG
@@ -181,6 +238,18 @@ class Adafruit_SSD1306 : public Adafruit_GFX {
   uint32_t     restoreClk; // Wire speed following SSD1306 transfers
 #endif
   uint8_t      contrast;    // normal contrast setting for this device
+  uint8_t      dirtyMin[SSD1306_MAXPAGES]; // First changed column per page
+  uint8_t      dirtyMax[SSD1306_MAXPAGES]; // Last changed column per page
+  uint8_t      flushMin[SSD1306_MAXPAGES]; // Next column to send per page
+  uint8_t      flushMax[SSD1306_MAXPAGES]; // Last column to send per page
+  uint8_t      flushPage;   // Page currently being sent by flushStep()
+  uint8_t      flushLast;   // Last page of open window, 0xFF if none
+  uint8_t      flushEnd;    // Last column of open window
+  uint8_t      shadowStale; // Pages the shadow may not match, a bit each
+  uint8_t      shadowResend; // Of those, pages being flushed whole
+#ifdef SSD1306_TWI_STREAM
+  uint8_t      flushRows;   // Pages handed to the TWI stream, 0 if none
+#endif
 #if defined(SPI_HAS_TRANSACTION)
 protected:
   // Allow sub-class to change
@@ -188,4 +257,49 @@ protected:
 #endif
 };
 
+/*!
+    @brief  Page-at-a-time ("strip") variant of Adafruit_SSD1306. Only a
+            single WIDTH-byte page buffer is allocated; a render callback
+            is replayed once per 8-row page and each page is sent to the
+            display as soon as it has been drawn.
+*/
+class Adafruit_SSD1306_Strip : public Adafruit_SSD1306 {
+ public:
+  /// Draws the whole screen; called once per page, output is clipped.
+  typedef void (*RenderCallback)(Adafruit_GFX &gfx);
+
+  Adafruit_SSD1306_Strip(uint8_t w, uint8_t h, TwoWire *twi=&Wire,
+    int8_t rst_pin=-1, uint32_t clkDuring=400000UL,
+    uint32_t clkAfter=100000UL);
+  Adafruit_SSD1306_Strip(uint8_t w, uint8_t h, SPIClass *spi,
+    int8_t dc_pin, int8_t rst_pin, int8_t cs_pin, uint32_t bitrate=8000000UL);
+
+  boolean      begin(uint8_t switchvcc=SSD1306_SWITCHCAPVCC,
+                 uint8_t i2caddr=0, boolean reset=true,
+                 boolean periphBegin=true);
+  void         setRenderer(RenderCallback cb);
+  void         displayRegion(int16_t x, int16_t y, int16_t w, int16_t h);
+  boolean      setFrameDiff(boolean enable);
+  void         beginFlush(void);
+  boolean      flushStep(uint32_t budget_us=0);
+  void         clearDisplay(void);
+  void         drawPixel(int16_t x, int16_t y, uint16_t color);
+  void         drawChar(int16_t x, int16_t y, unsigned char c,
+                 uint16_t color, uint16_t bg, uint8_t size);
+  void         drawPageBitmap(int16_t x, uint8_t page, const uint8_t *bitmap,
+                 uint8_t w, uint8_t pages);
+  boolean      getPixel(int16_t x, int16_t y);
+
+ protected:
+  void         drawFastHLineInternal(int16_t x, int16_t y, int16_t w,
+                 uint16_t color);
+  void         drawFastVLineInternal(int16_t x, int16_t y, int16_t h,
+                 uint16_t color);
+  void         fillRectInternal(int16_t x, int16_t y, int16_t w, int16_t h,
+                 uint16_t color);
+
+  RenderCallback renderer;
+  uint8_t      stripPage;   // Page currently held in the buffer
+};
+
 #endif // _Adafruit_SSD1306_H_
@@ -0,0 +1,258 @@
+/*!
+ * @file SSD1306_TWI.cpp
+ *
+ * Interrupt-driven AVR TWI master; see SSD1306_TWI.h. Only built when
+ * SSD1306_TWI_ISR is defined in Adafruit_SSD1306.h.
+ */
+
+#include "Adafruit_SSD1306.h"
+
+#ifdef SSD1306_TWI_STREAM
+
+#include <avr/interrupt.h>
+#include <util/twi.h>
+
+SSD1306_TWI Wire;
+
+ISR(TWI_vect) {
+  Wire.handleInterrupt();
+}
+
+#define TWCR_GO (_BV(TWINT) | _BV(TWEN) | _BV(TWIE)) ///< Carry on
+
+/*!
+    @brief  Constructor; call begin() before use.
+*/
+SSD1306_TWI::SSD1306_TWI(void) : error(0), state(TWI_IDLE), sla(0),
+  twbr(72), length(0), index(0), received(0), data(NULL), control(-1),
+  width(0), stride(0), rows(0), column(0), row(0), streaming(false),
+  streamed(0), pausing(false) {
+}
+
+/*!
+    @brief  Enable the TWI at 100 KHz, with the internal pull-ups on.
+*/
+void SSD1306_TWI::begin(void) {
+  digitalWrite(SDA, HIGH);
+  digitalWrite(SCL, HIGH);
+  TWSR = 0; // Prescaler 1
+  setClock(100000UL);
+  TWBR = twbr;
+  TWCR = _BV(TWEN) | _BV(TWIE);
+}
+
+/*!
+    @brief  Set the SCL clock for the transfers that follow. One already
+            in progress carries on at its own.
+    @param  clock
+            Hz, up to F_CPU / 16.
+*/
+void SSD1306_TWI::setClock(uint32_t clock) {
+  uint32_t div = F_CPU / clock;
+  twbr = (div <= 16) ? 0 : ((div - 16) / 2 > 255) ? 255 : (div - 16) / 2;
+}
+
+/*!
+    @brief  Start buffering a write to 'address', waiting for any transfer
+            still in progress.
+*/
+void SSD1306_TWI::beginTransmission(uint8_t address) {
+  while(busy());
+  sla    = address << 1 | TW_WRITE;
+  length = 0;
+}
+
+/*!
+    @brief  Buffer a byte of the write.
+    @return 1, or 0 if the buffer is full.
+*/
+size_t SSD1306_TWI::write(uint8_t d) {
+  if(length >= BUFFER_LENGTH) return 0;
+  buffer[length++] = d;
+  return 1;
+}
+
+/*!
+    @brief  Send the buffered write and wait for it to finish.
+    @return 0 on success, 2 if the address was not acknowledged, 3 if
+            data was not, 4 on a bus error, as Wire.
+*/
+uint8_t SSD1306_TWI::endTransmission(void) {
+  streaming = false;
+  data    = buffer;
+  control = -1;
+  width   = length;
+  stride  = length;
+  rows    = length ? 1 : 0; // Nothing but the address to probe it
+  start();
+  return wait();
+}
+
+/*!
+    @brief  Read 'quantity' bytes from 'address' and wait for them.
+    @return Bytes read, 0 on failure.
+*/
+uint8_t SSD1306_TWI::requestFrom(uint8_t address, uint8_t quantity) {
+  while(busy());
+  if(!quantity) return 0;
+  if(quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+  streaming = false;
+  sla      = address << 1 | TW_READ;
+  length   = quantity;
+  index    = 0;
+  received = 0;
+  start();
+  return wait() ? 0 : received;
+}
+
+/*!
+    @brief  Bytes read back and not yet taken with read().
+*/
+int SSD1306_TWI::available(void) {
+  return received - index;
+}
+
+/*!
+    @brief  Take the next byte read back.
+    @return The byte, or -1 if there are none left.
+*/
+int SSD1306_TWI::read(void) {
+  return (index < received) ? buffer[index++] : -1;
+}
+
+/*!
+    @brief  Start writing rows of a buffer to 'address' in one transaction,
+            returning at once: the TWI interrupt sends each byte.
+    @param  address
+            7-bit I2C address.
+    @param  control
+            Byte to send first (e.g. the SSD1306's 0x40 for GDDRAM data).
+    @param  data
+            First byte of the first row. Must stay unchanged until busy()
+            is false.
+    @param  width
+            Bytes per row.
+    @param  stride
+            Bytes from the start of one row to the next.
+    @param  rows
+            Number of rows.
+    @return false (and nothing is sent) if a transfer is in progress.
+    @note   pause() stops a stream at the end of a row, one row in at
+            least; rowsSent() then says how far it got.
+*/
+boolean SSD1306_TWI::stream(uint8_t address, uint8_t control,
+  const uint8_t *data, uint8_t width, uint16_t stride, uint8_t rows) {
+  if(busy()) return false;
+  sla           = address << 1 | TW_WRITE;
+  this->data    = data;
+  this->control = control;
+  this->width   = width;
+  this->stride  = stride;
+  this->rows    = rows;
+  streaming     = true;
+  streamed      = 0;
+  start();
+  return true;
+}
+
+/*!
+    @brief  Stop a stream at the end of the row it is sending, and wait
+            for it to stop. Returns at once if nothing is being sent.
+*/
+void SSD1306_TWI::pause(void) {
+  pausing = true;
+  while(busy());
+}
+
+// Send START; the interrupt takes it from there
+void SSD1306_TWI::start(void) {
+  column  = 0;
+  row     = 0;
+  pausing = false;
+  error   = 0;
+  state   = (sla & TW_READ) ? TWI_READING : TWI_WRITING;
+  TWBR    = twbr;
+  TWCR    = TWCR_GO | _BV(TWSTA);
+}
+
+// Send STOP and end the transfer with 'err'
+void SSD1306_TWI::stop(uint8_t err) {
+  TWCR  = TWCR_GO | _BV(TWSTO);
+  while(TWCR & _BV(TWSTO)); // About a bit time
+  end(err);
+}
+
+// The transfer is over, with 'err'
+void SSD1306_TWI::end(uint8_t err) {
+  if(streaming) streamed = err ? 0 : row;
+  error = err;
+  state = TWI_IDLE;
+}
+
+// Wait for the transfer to finish, returning its error
+uint8_t SSD1306_TWI::wait(void) {
+  while(busy());
+  return error;
+}
+
+/*!
+    @brief  Advance the transfer by one bus event. Called from the TWI
+            interrupt.
+*/
+void SSD1306_TWI::handleInterrupt(void) {
+  switch(TW_STATUS) {
+   case TW_START:
+   case TW_REP_START:
+    TWDR = sla;
+    TWCR = TWCR_GO;
+    break;
+
+   // Writing
+   case TW_MT_SLA_ACK:
+   case TW_MT_DATA_ACK:
+    if(control >= 0) {
+      TWDR    = control;
+      control = -1;
+    } else if((row >= rows) || (pausing && !column && row)) {
+      stop(0);
+      break;
+    } else {
+      TWDR = data[column];
+      if(++column >= width) { // Row sent, on to the next
+        column = 0;
+        data  += stride;
+        row++;
+      }
+    }
+    TWCR = TWCR_GO;
+    break;
+   case TW_MT_SLA_NACK:
+    stop(2);
+    break;
+   case TW_MT_DATA_NACK:
+    stop(3);
+    break;
+
+   // Reading: acknowledge every byte but the last
+   case TW_MR_DATA_ACK:
+    buffer[received++] = TWDR;
+    // Fall through
+   case TW_MR_SLA_ACK:
+    TWCR = TWCR_GO | (((received + 1) < length) ? _BV(TWEA) : 0);
+    break;
+   case TW_MR_DATA_NACK:
+    buffer[received++] = TWDR;
+    stop(0);
+    break;
+   case TW_MR_SLA_NACK:
+    stop(2);
+    break;
+
+   default: // Arbitration lost or bus error
+    TWCR = _BV(TWEN) | _BV(TWIE);
+    end(4);
+    break;
+  }
+}
+
+#endif // SSD1306_TWI_STREAM
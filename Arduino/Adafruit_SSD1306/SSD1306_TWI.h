@@ -0,0 +1,92 @@
+/*!
+ * @file SSD1306_TWI.h
+ *
+ * Interrupt-driven AVR TWI (I2C) master, used in place of the Wire library
+ * when SSD1306_TWI_ISR is defined in Adafruit_SSD1306.h.
+ *
+ * Besides the Wire calls the library (and other devices' drivers) make,
+ * it can stream rows straight out of a buffer in a single I2C transaction:
+ * the TWI interrupt sends each byte, so the CPU is free for other work
+ * until the transfer is over, and nothing is copied into a 32-byte Wire
+ * buffer on the way.
+ *
+ * Wire's own TWI code (utility/twi.c) defines ISR(TWI_vect) as well, so
+ * the two cannot be linked together: with SSD1306_TWI_ISR nothing in the
+ * sketch may include Wire.h. This file stands in for it, with the same
+ * TwoWire type and Wire object for the calls it supports.
+ */
+
+#ifndef _SSD1306_TWI_H_
+#define _SSD1306_TWI_H_
+
+#include <Arduino.h>
+
+#define BUFFER_LENGTH 32 ///< Bytes per buffered transfer, as Wire's
+
+/*!
+    @brief  Interrupt-driven TWI master with Wire's master calls and
+            streaming of buffer rows.
+*/
+class SSD1306_TWI {
+ public:
+  SSD1306_TWI(void);
+
+  // The subset of TwoWire used by the library and the sketch. Each of
+  // these waits until its transfer is over.
+  void    begin(void);
+  void    setClock(uint32_t clock);
+  void    beginTransmission(uint8_t address);
+  void    beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  size_t  write(uint8_t data);
+  uint8_t endTransmission(void);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity);
+  int     available(void);
+  int     read(void);
+
+  boolean stream(uint8_t address, uint8_t control, const uint8_t *data,
+            uint8_t width, uint16_t stride, uint8_t rows);
+  /// True while a transfer is in progress
+  boolean busy(void) { return state != TWI_IDLE; }
+  void    pause(void);
+  /// Rows the last stream sent; none if it failed, as it is not known
+  /// what the device took
+  uint8_t rowsSent(void) { return streamed; }
+
+  void    handleInterrupt(void);
+
+  volatile uint8_t error; ///< Of the last transfer, as endTransmission()
+
+ private:
+  enum { TWI_IDLE, TWI_WRITING, TWI_READING };
+
+  void    start(void);
+  void    stop(uint8_t err);
+  void    end(uint8_t err);
+  uint8_t wait(void);
+
+  volatile uint8_t  state;
+  uint8_t           sla;      // Address and read/write bit
+  uint8_t           twbr;     // Clock divider for the next transfer
+  uint8_t           buffer[BUFFER_LENGTH];
+  uint8_t           length;   // Bytes buffered, or to read
+  uint8_t           index;    // Next byte read back
+  volatile uint8_t  received;
+
+  // What is being written: an optional control byte, then 'rows' rows of
+  // 'width' bytes, 'stride' apart
+  const uint8_t    *data;
+  int16_t           control;  // -1 if none
+  uint8_t           width;
+  uint16_t          stride;
+  uint8_t           rows;
+  uint8_t           column;
+  volatile uint8_t  row;
+  boolean           streaming; // A stream rather than a buffered write
+  volatile uint8_t  streamed;  // Rows of the last stream sent
+  volatile boolean  pausing;   // Stop at the end of the row being sent
+};
+
+typedef SSD1306_TWI TwoWire; ///< Stands in for Wire's class...
+extern SSD1306_TWI  Wire;    ///< ...and its object
+
+#endif // _SSD1306_TWI_H_
@@ -0,0 +1,51 @@
+/**************************************************************************
+ This is an example for our Monochrome OLEDs based on SSD1306 drivers,
+ using page-at-a-time ("strip") rendering to save RAM.
+
+ Instead of a 512 byte framebuffer, Adafruit_SSD1306_Strip keeps a single
+ 128 byte page. The screen is drawn by a render callback that display()
+ calls once for each 8-row page, sending each page as soon as it is done.
+
+ This example is for a 128x32 pixel display using I2C to communicate.
+
+ BSD license, check license.txt for more information
+ All text above must be included in any redistribution.
+ **************************************************************************/
+
+#include <SPI.h>
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+
+#define SCREEN_WIDTH 128 // OLED display width, in pixels
+#define SCREEN_HEIGHT 32 // OLED display height, in pixels
+
+Adafruit_SSD1306_Strip display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, -1);
+
+unsigned long counter = 0;
+
+// Draws the complete screen. Called once per page, so it must not depend
+// on anything drawn by a previous call (set the cursor every time).
+void drawScreen(Adafruit_GFX &gfx) {
+  gfx.drawRect(0, 0, gfx.width(), gfx.height(), SSD1306_WHITE);
+  gfx.setTextSize(2);
+  gfx.setTextColor(SSD1306_WHITE);
+  gfx.setCursor(8, 9);
+  gfx.print(counter);
+}
+
+void setup() {
+  Serial.begin(9600);
+
+  if(!display.begin(SSD1306_SWITCHCAPVCC, 0x3C)) { // Address 0x3C for 128x32
+    Serial.println(F("SSD1306 allocation failed"));
+    for(;;); // Don't proceed, loop forever
+  }
+  display.setRenderer(drawScreen);
+}
+
+void loop() {
+  display.display(); // Renders and sends all four pages
+  counter++;
+  delay(100);
+}
@@ -0,0 +1,54 @@
+#!/usr/bin/env python3
+# Pre-renders text labels in the 'classic' Adafruit_GFX 5x7 font as
+# SSD1306 page-major bitmaps (one byte = 8 vertical pixels, LSB on top),
+# ready for Adafruit_SSD1306::drawPageBitmap().
+
+import re
+import sys
+
+def load_font(fn):
+    with open(fn) as f:
+        src = f.read()
+    body = src[src.index('{') + 1:src.rindex('}')]
+    body = re.sub(r'//.*', '', body)
+    return [int(v, 16) for v in re.findall(r'0x[0-9A-Fa-f]{2}', body)]
+
+def render(font, text, size):
+    # Columns of 8*size bits, 6*size per character less the trailing gap
+    cols = []
+    for c in text.encode('cp437'):
+        for i in range(6):
+            line = font[c * 5 + i] if i < 5 else 0
+            bits = 0
+            for j in range(8):
+                if line & (1 << j):
+                    bits |= ((1 << size) - 1) << (j * size)
+            cols.extend([bits] * size)
+    return cols[:len(cols) - size]
+
+def main(fontfile, size, labels):
+    font = load_font(fontfile)
+    print("\n// Generated by make_labels.py, text size {}".format(size))
+    for label in labels:
+        id, text = label.split('=', 1)
+        cols = render(font, text, size)
+        pages = size
+        print("\n"
+              "#define {id}_width {w}\n"
+              "#define {id}_pages {p}\n"
+              "\n"
+              "const uint8_t PROGMEM {id}_data[] = {{\n"
+              .format(id=id, w=len(cols), p=pages), end='')
+        for p in range(pages):
+            print("  // page {}".format(p))
+            row = ["0x{:02X}".format((c >> (8 * p)) & 0xFF) for c in cols]
+            for i in range(0, len(row), 12):
+                print("  " + ",".join(row[i:i + 12]) + ",")
+        print("};")
+
+if __name__ == '__main__':
+    if len(sys.argv) < 4:
+        print("Usage: {} <glcdfont.c> <size> <id>=<text> ...\n".format(
+            sys.argv[0]), file=sys.stderr)
+        sys.exit(1)
+    main(sys.argv[1], int(sys.argv[2]), sys.argv[3:])
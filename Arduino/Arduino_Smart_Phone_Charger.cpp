@@ -5,11 +5,22 @@
 #include "Arduino_Smart_Phone_Charger.h"
 #include "Arduino.h"
 #include <SoftwareSerial.h>
-#include <stdlib.h> // required for atoi
 
-#include <wire.h>
 #include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
+#include <Adafruit_SSD1306.h> // Includes Wire, unless SSD1306_TWI_ISR
+
+// Static screen text pre-rendered at text size 2 (see
+// Adafruit_SSD1306/scripts/make_labels.py)
+#include "labels.h"
+
+#include "Scheduler.h"
+#include "BTFrameParser.h"
+#include "Filters.h"
+#include "ChargeCounter.h"
+#include "BatteryEstimator.h"
+#include "TransientCapture.h"
+#include "TaperDetector.h"
+#include "I2CBus.h"
 
 // If you are using an HC06 set the following line to false
 #define USING_HC05 true
@@ -29,16 +40,21 @@ SoftwareSerial BTserial(4, 6); // RX , TX
 // Our BT Serial Buffer where BT sends its text data to the Arduino
 char buffer[19] = { '\0' };
 
+// Finds the frames in the BT byte stream and copies them to buffer
+BTFrameParser btParser(buffer);
+
 // Get the flag to show whether the phone thinks it is plugged in
 bool isPluggedIn = false;
 
-// Conversion buffer for the individual 3-digit integer values
-char btValue[4] = { 0 };
-
-// Heartbeat buffer (string) will contain "HEARTBEATn"
-char heartBeat[11] = { '\0' };
 unsigned long lastHeartBeat = 0;
 
+// When the last byte came from the phone
+unsigned long lastBTByte = 0;
+
+// A partial frame is discarded when no more bytes arrive for this long
+// (at 9600 baud the 18 bytes of a frame take under 20mS)
+#define btFrameGapMs 50
+
 // Connected? Only works on HC-05
 #define connectedState 10
 bool prevStateDisconnected = true;
@@ -56,16 +72,101 @@ bool prevStateDisconnected = true;
 // Note this depends on whehter the output is HIGH or LOW in Setup()
 bool chargingUp = true;
 int batLevel = 0;
+int maxCharge = 0;
+int minCharge = 0;
+
+// Set when a battery level frame has arrived for the control policy
+bool newBatteryLevel = false;
+
+// Time for charging to start after switching on, before sampling current
+#define chargeStartMs 2250
+
+// Rolling average for current consumption (due to phone jitter), over 8
+// seconds after a median of 3 has taken out single-sample spikes
+Median<uint16_t, 3> mAMedian;
+Boxcar<uint16_t, 16> mAAverage;
+int chargemA = 0;
+#define currentSampleMs 500
 
-// Rolling average for current consumption (due to phone jitter)
-uint16_t mA_Average[20] = { 0 };
-uint8_t mAIdx = 0;
+// Current samples since the last telemetry record
+uint32_t telemetrySum = 0;
+uint16_t telemetrySamples = 0;
+uint16_t telemetryMin = 0xFFFF;
+uint16_t telemetryMax = 0;
+
+// Charge and energy delivered since the phone connected
+ChargeCounter chargeCounter;
+
+// Battery level between the phone's reports
+BatteryEstimator batteryEstimate;
+
+// ... and from the charge current alone, once the phone has gone quiet for
+// this long (its app asleep: no levels, no heartbeats), stopping at the
+// phone's maxCharge or, if it has not sent one yet, this
+TaperDetector taper;
+#define phoneSilentMs 120000UL
+#define defaultMaxCharge 80
+
+// Telemetry records go to the phone no more often than this
+#define telemetryMs 10000
 
 // If we have never started charging pre-fill the above array on first charge
 bool firstCharge = true;
 
 // I2C address of the INA219 device (can be changed by soldering board)
-byte response, hexAddress = 0x40;
+byte hexAddress = 0x40;
+INA219 ina219(hexAddress);
+
+// 0.1 ohm shunt, up to 2A (100uA LSB), 8 x gain (320mV), 8 samples averaged
+typedef INA219Calibration<100, 2000, 8, 8> ina219Cal;
+#define ina219ConversionMs (ina219Cal::conversionMicros / 1000 + 1)
+
+// The power LED draws its share of the current through the shunt
+#define ledMilliAmps 16
+
+// ... and of the power: 16mA x the bus voltage (4mV LSB, 13 bits)
+typedef INA219Scale<4 * ledMilliAmps, 1000, 8191> ledPower;
+
+// Current transients after each switch, single 532uS samples (the same
+// calibration: only the averaging differs)
+typedef INA219Calibration<100, 2000, 8, 1> ina219CaptureCal;
+static_assert(ina219CaptureCal::calibration == ina219Cal::calibration,
+		"Capture and charge readings must share a calibration");
+TransientCapture capture(4); // Changes up to 4mA count as noise
+unsigned long captureStarted = 0;
+unsigned long lastCaptureSample = 0;
+
+// Long enough to see charging start after chargeStartMs
+#define captureMs 3000
+
+// The INA219 and the SSD1306 share the I2C bus. Current readings come
+// first: a display flush gives way to them between chunks. A current
+// register read takes about 600uS at Wire's default 100kHz, too long for
+// every conversion of a capture, so both start at 400kHz.
+#define ina219I2CClock 400000UL
+#define displayI2CClock 400000UL
+
+// Then each is tuned to the fastest clock it keeps up with, kept in EEPROM
+// from one start to the next: the display up to 1MHz, the INA219 no
+// faster than the 400kHz it is rated to. Above that it needs high-speed
+// mode, entered with a master code Wire does not send, however well one
+// chip reads back.
+#define USING_I2C_TUNING true
+#define maxINA219Clock 400000UL
+#define maxDisplayClock 1000000UL
+#define eepromINA219Clock 0   // 3 bytes each
+#define eepromDisplayClock 3
+I2CBus i2cBus(Wire);
+I2CBusClient ina219Bus(i2cBus, I2C_PRIORITY_SENSOR, ina219I2CClock);
+I2CBusClient displayBus(i2cBus, I2C_PRIORITY_DISPLAY, displayI2CClock);
+
+// Where the captures being sent have got to, -1 when not sending, and
+// which capture was the latest when sending began
+int16_t serialDumpAt = -1;
+uint8_t serialDumpCaptures = 0;
+TransientCapture::Record serialDumpRecord;
+int16_t btDumpAt = -1;
+uint8_t btDumpCaptures = 0;
 
 // SSD1306 OLED Display
 //#define SCREEN_WIDTH 128 // OLED display width, in pixels
@@ -75,22 +176,79 @@ byte response, hexAddress = 0x40;
 // New method of invoking the SSD1306 object
 Adafruit_SSD1306 display(128, 32);
 
+// Copy a pre-rendered label to column x, 8-row page (0 - 3) of the screen
+#define displayLabel(x, page, label) \
+	display.drawPageBitmap(x, page, label##_data, label##_width, label##_pages)
+
 // Forward declarations
+void processBTdata();
 void printDateTimeStamp(char buffer[15]);
-void displayBTbuffer();
-bool extractHeartBeatFromBTdata(int startIdx, int endIdx);
-int extractDataFromBTdata(int startIdx, int endIdx);
 void printRawData();
 void pluggedInStatus();
 void displayBatteryPercent();
 
 // SSD1306 OLED
-void displayHeartBeat();
+void displayHeartBeat(bool show);
 void displayChargeStatus(bool charging = true);
+void displaySessionTotals();
+void refreshDisplay();
 
 // INA219 Current Monitor
 void INA219_setup();
+bool checkINA219();
+bool checkDisplay();
 int getMilliAmps();
+void chargeOn();
+void chargeOff();
+void startCapture(uint8_t event);
+void stopCapture();
+int16_t printCapture(int16_t pos);
+int16_t sendCapture(int16_t pos);
+
+// Tasks, each run by the scheduler when due. None of them may block.
+void connectionTask();
+void btReceiveTask();
+void controlTask();
+void currentSampleTask();
+void displayTask();
+void heartbeatAnimationTask();
+void heartbeatTimeoutTask();
+void displayFlushTask();
+void telemetryTask();
+void captureTask();
+void captureDumpTask();
+
+enum
+{
+	TASK_CONNECTION,
+	TASK_BT_RX,
+	TASK_CONTROL,
+	TASK_CURRENT,
+	TASK_DISPLAY,
+	TASK_HEARTBEAT_ANIMATION,
+	TASK_HEARTBEAT_TIMEOUT,
+	TASK_DISPLAY_FLUSH,
+	TASK_TELEMETRY,
+	TASK_CAPTURE,
+	TASK_CAPTURE_DUMP,
+	TASK_COUNT
+};
+
+// Only the connection check runs until the phone connects
+Scheduler::Task tasks[TASK_COUNT] = {
+	{ connectionTask, 100, 0, true },
+	{ btReceiveTask, 10, 0, false },
+	{ controlTask, 1000, 0, false },
+	{ currentSampleTask, currentSampleMs, 0, false },
+	{ displayTask, 500, 0, false },
+	{ heartbeatAnimationTask, 400, 0, false },
+	{ heartbeatTimeoutTask, 1000, 0, false },
+	{ displayFlushTask, 0, 0, false },
+	{ telemetryTask, telemetryMs, 0, false },
+	{ captureTask, 0, 0, false },
+	{ captureDumpTask, 50, 0, true }
+};
+Scheduler scheduler(tasks, TASK_COUNT);
 
 // DEBUG flag controls whether we send Serial.print statements
 // #define DEBUGMSG 1
@@ -121,14 +279,13 @@ void setup() {
 	// Set baud rate of HC-06 that you set up using the FTDI USB-to-Serial module
 	BTserial.begin(9600);
 
-	// Ensure we don't wait forever for a BT character
-	BTserial.setTimeout(2000); //mS
-
 	// INA219 Current Monitor initialisation
 	INA219_setup();
 
-	// SSD1306 initialize with the I2C addr 0x3C (for the 128x32)
-	if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C))
+	// SSD1306 initialize with the I2C addr 0x3C (for the 128x32), on the
+	// bus INA219_setup() has started
+	display.setBus(&displayBus);
+	if (!display.begin(SSD1306_SWITCHCAPVCC, 0x3C, true, false))
 	{
 #ifdef DEBUGMSG
 		Serial.println(F("SSD1306 allocation failed"));
@@ -137,6 +294,18 @@ void setup() {
 			; // Don't proceed, loop forever
 	}
 
+#if USING_I2C_TUNING
+	ina219Bus.tune(checkINA219, eepromINA219Clock, maxINA219Clock);
+	displayBus.tune(checkDisplay, eepromDisplayClock, maxDisplayClock);
+#ifdef DEBUGMSG
+	Serial.print(F("I2C clocks: INA219 "));
+	Serial.print(ina219Bus.clock / 1000);
+	Serial.print(F("kHz, display "));
+	Serial.print(displayBus.clock / 1000);
+	Serial.println(F("kHz"));
+#endif
+#endif
+
 	// Clear the buffer.
 	display.clearDisplay();
 	display.display();
@@ -161,6 +330,7 @@ void setup() {
 #endif
 
 	displayNotConnected();
+	display.display();
 	delay(2000);
 
 	// Setup done
@@ -169,304 +339,586 @@ void setup() {
 #endif
 }
 
-// Main process to inspect the BT data from phone
+// Main process to inspect a complete frame of BT data from phone
 void processBTdata()
 {
-	// Get the chars. This blocks until the number specified
-	// has been read or it times out
-	int byteCount = BTserial.readBytes(buffer, 18);
+	BTFrame frame;
+	if (btParser.version == BT_VERSION)
+	{
+		// Binary frames are checked and decoded as they arrive
+		frame = btParser.decoded;
+	} else
+	{
+		// Legacy 18-byte text frame
+		// Useful to see the raw BT buffer in debugging
+		printRawData();
 
-	// Useful to see the raw BT buffer in debugging
-	printRawData();
+		// One pass over the frame for all of its fields
+		if (!decodeBTFrame(buffer, frame))
+		{
+#ifdef DEBUGMSG
+			Serial.println(F("Frame out of range - ignored."));
+#endif
+			return;
+		}
 
-	// If we timed out we won't have the full X bytes
-	if (byteCount == 18)
-	{
 		// first 8 chars are time format "hh:MM:ss"
 		printDateTimeStamp(buffer);
+	}
 
-		// Flag for whether phone is currently plugged in
-		isPluggedIn = buffer[17] == '1';
+	// Flag for whether phone is currently plugged in
+	isPluggedIn = frame.pluggedIn;
 
-		// Is this the heartbeat?
-		if (extractHeartBeatFromBTdata(8, 16))
-		{
+	// Is this the heartbeat?
+	if (frame.heartbeat)
+	{
 #ifdef DEBUGMSG
-			Serial.println(F("Heartbeat received."));
+		Serial.println(F("Heartbeat received."));
 #endif
-			pluggedInStatus();
+		pluggedInStatus();
+
+		// Reset the heartbeat clock so we don't get a warning
+		lastHeartBeat = millis();
+	} else
+	{
+		batLevel = frame.battery;
+		maxCharge = frame.maxCharge;
+		minCharge = frame.minCharge;
 
-			// SSD1306 show the heart symbol
-			displayHeartBeat();
+#ifdef DEBUGMSG
+		Serial.print(F("Battery Level:"));
+		Serial.print(batLevel);
+		Serial.print(F(" Max Charge Level:"));
+		Serial.print(maxCharge);
+		Serial.print(F(" Min charge Level:"));
+		Serial.println(minCharge);
 
-			// Reset the heartbeat clock so we don't get a warning
-			lastHeartBeat = millis();
+		Serial.print(F("Phone plugged in:"));
+
+		if (isPluggedIn)
+		{
+			Serial.println(F("Yes"));
 		} else
 		{
-			/* This next section extracts the integer values from
-			 * the text data, and displays lots of debugging info
-			 * so we can track what is going on whilst developing
-			 * this program!
-			 */
-			batLevel = extractDataFromBTdata(8, 10);
-#ifdef DEBUGMSG
-			Serial.print(F("Battery Level:"));
-			Serial.print(batLevel);
+			Serial.println(F("No"));
+		}
 #endif
-			displayBTbuffer();
 
-			printDateTimeStamp(buffer);
+		// Let the control policy act on it straight away
+		newBatteryLevel = true;
+		scheduler.runIn(TASK_CONTROL, 0);
 
-			int maxCharge = extractDataFromBTdata(11, 13);
-#ifdef DEBUGMSG
-			Serial.print(F("Max Charge Level:"));
-			Serial.print(maxCharge);
-#endif
-			displayBTbuffer();
-
-			printDateTimeStamp(buffer);
+		// Data in lieu of heartbeat still counts as heartbeat
+		lastHeartBeat = millis();
+	}
+}
 
-			int minCharge = extractDataFromBTdata(14, 16);
+// Switch charging on or off on the latest battery level from the phone
+void controlTask()
+{
+	if (!newBatteryLevel)
+	{
+		// Between frames, stop as soon as the estimate reaches max
+		if (chargingUp
+				&& batteryEstimate.reached(maxCharge,
+						chargeCounter.milliAmpHours()))
+		{
 #ifdef DEBUGMSG
-			Serial.print(F("Min charge Level:"));
-			Serial.print(minCharge);
+			Serial.print(F("Estimated battery level "));
+			Serial.print(batteryEstimate.level(chargeCounter.milliAmpHours()));
+			Serial.println(F("% - charging stopped."));
 #endif
-			displayBTbuffer();
-
-			printDateTimeStamp(buffer);
+			chargeOff();
+		}
 
+		// Nothing from the phone at all: stop on the charge current's taper.
+		// Only received bytes count: the heartbeat timeout resets its own
+		// clock.
+		else if (chargingUp && millis() - lastBTByte >= phoneSilentMs
+				&& taper.level(chargemA)
+						>= (maxCharge ? maxCharge : defaultMaxCharge))
+		{
 #ifdef DEBUGMSG
-			Serial.print(F("Phone plugged in:"));
-
-			if (isPluggedIn)
-			{
-				Serial.println(F("Yes"));
-			} else
-			{
-				Serial.println(F("No"));
-			}
+			Serial.print(F("Phone silent, charge current tapering at "));
+			Serial.print(taper.level(chargemA));
+			Serial.println(F("% - charging stopped."));
 #endif
-
-			// If the battery is now >= max wanted, switch off
-			if (batLevel >= maxCharge && chargingUp)
-			{
-				digitalWrite(pwrControlLED, LOW);
-				chargingUp = false;
-			}
-
-			// If the battery is now <= min wanted, switch on
-			if (batLevel <= minCharge && !chargingUp)
-			{
-				digitalWrite(pwrControlLED, HIGH);
-				chargingUp = true;
-				delay(2250); // give time for charging to start
-			}
-
-			printDateTimeStamp(buffer);
-			displayBatteryPercent();
-
-			// Is phone plugged in when it should be?
-			pluggedInStatus();
-
-			// Data in lieu of heartbeat still counts as heartbeat
-			lastHeartBeat = millis();
+			chargeOff();
 		}
-	} else
+		return;
+	}
+	newBatteryLevel = false;
+	batteryEstimate.report(batLevel, chargeCounter.milliAmpHours(),
+			chargingUp);
+
+	// If the battery is now >= max wanted, switch off
+	if (batLevel >= maxCharge && chargingUp)
 	{
-#ifdef DEBUGMSG
-		Serial.print(F("Only received "));
-		Serial.print(byteCount);
-		Serial.println(F(" characters - ignored."));
-#endif
+		chargeOff();
 	}
 
-	// Discard partial data in serial buffer
-	while (BTserial.available())
+	// If the battery is now <= min wanted, switch on
+	if (batLevel <= minCharge && !chargingUp)
 	{
-		BTserial.read();
-#ifdef DEBUGMSG
-		Serial.println(F("Discarded a serial character."));
-#endif
+		chargeOn();
 	}
 
+	printDateTimeStamp(buffer);
+	displayBatteryPercent();
+
+	// Is phone plugged in when it should be?
+	pluggedInStatus();
+}
+
+// Switch the phone's power on
+void chargeOn()
+{
+	startCapture(CAPTURE_ON);
+	digitalWrite(pwrControlLED, HIGH);
+	chargingUp = true;
+	taper.reset();
+
+	// give time for charging to start before sampling the current
+	scheduler.runIn(TASK_CURRENT, chargeStartMs);
+}
+
+// Switch the phone's power off
+void chargeOff()
+{
+	startCapture(CAPTURE_OFF);
+	digitalWrite(pwrControlLED, LOW);
+	chargingUp = false;
+
+	// Nothing to count until charging starts again
+	chargeCounter.pause();
 }
 
 // -----------------------------------------------------------------------------------
 // MAIN LOOP     MAIN LOOP     MAIN LOOP     MAIN LOOP     MAIN LOOP     MAIN LOOP
 // -----------------------------------------------------------------------------------
 void loop() {
-	/* If the HC-06/05 has some data for us, get it.
-	 *
-	 * First 8 bytes time in text format hh:MM:ss
-	 *
-	 * Then follows three variables of 3 bytes each in text format
-	 * that contain the current battery level, the level at which the
-	 * user wants to start charging and the level the user wants to
-	 * stop charging
-	 *
-	 * The final byte is whether the phone is currently plugged in.
-	 *
-	 * If there has been no change to the battery level then a
-	 * heartbeat is sent just so that this sketch knows the phone
-	 * is still sending data down the line
-	 */
+	scheduler.run();
+}
 
+// -----------------------------------------------------------------------------------
+// TASKS     TASKS     TASKS     TASKS     TASKS     TASKS     TASKS     TASKS
+// -----------------------------------------------------------------------------------
+
+// Tasks that only run while the phone is connected
+const uint8_t connectedTasks[] = { TASK_BT_RX, TASK_CONTROL, TASK_CURRENT,
+		TASK_DISPLAY, TASK_HEARTBEAT_ANIMATION, TASK_HEARTBEAT_TIMEOUT,
+		TASK_TELEMETRY };
+
+// Track the BT connection and start/stop the other tasks with it
+void connectionTask()
+{
 #if USING_HC05
 	// Only if connected do any of this (assume HC06 always connected)
-	if (digitalRead(connectedState))
-	#else
+	bool connected = digitalRead(connectedState);
+#else
 	// When using HC06 cannot detected whether connected
-	if(true)
+	bool connected = true;
 #endif
+
+	// Nothing to do unless the state has changed
+	if (connected != prevStateDisconnected) return;
+	prevStateDisconnected = !connected;
+
+	for (uint8_t cnt = 0; cnt < sizeof(connectedTasks); cnt++)
 	{
-		// Confirm connected state if previously disconnected
-		if (prevStateDisconnected)
-		{
-			Serial.println(F("CONNECTED."));
-
-			// TODO move to function
-			// Display the heart
-			display.setTextSize(2);
-			display.setTextColor(SSD1306_WHITE);
-			display.setCursor(0, 15);     // x,y Start at top-left corner
-			display.print("CONNECTED");
-			display.display();
-
-			prevStateDisconnected = false;
-			// TODO Turn on the (blue) connected LED here
-		}
+		scheduler.enable(connectedTasks[cnt], connected);
+	}
 
-		// If we have serial data to process
-		if (BTserial.available())
-		{
-			// Get the chars. This blocks until the number specified
-			// has been read or it times out
-			processBTdata();
-		} else
-		{
-			// We ARE connected but no BT data to process at this time.
-
-			// Update charge current on screen
-			//if (chargingUp)
-			//{
-			displayHeartBeat();
-
-			// Toggle between charge current and battery level
-			static int displayCharge = 0;
-
-			if (++displayCharge > 10)
-			{
-				displayCharge = 0;
-				displayBatteryPercent();
-			}
-			else
-			{
-				displayCharge++;
-				displayChargeStatus(chargingUp);
-			}
-			//}
-
-			// Check last heartbeat
-			// See http://www.gammon.com.au/millis on why we do it this way
-			if (millis() - lastHeartBeat >= 300000UL)
-			{
+	if (connected)
+	{
+		Serial.println(F("CONNECTED."));
+
+		// Offer protocol v2; a phone that does not know it ignores this
+		uint8_t hello[BT_MAX_PAYLOAD + 4];
+		uint32_t version = BT_VERSION;
+		BTserial.write(hello, encodeBTFrame(hello, BT_HELLO, &version, 1));
+
+		// Report the charge delivered to this phone only, and learn
+		// its capacity afresh
+		chargeCounter.reset();
+		batteryEstimate.reset();
+		taper.reset();
+
+		// Give this phone the full time to speak before counting it silent
+		lastBTByte = millis();
+		scheduler.runIn(TASK_TELEMETRY, telemetryMs);
+
+		// "NOT CONNECTED" is showing: take away the NOT, clear of the heart
+		display.fillRect(10, 0, display.width() - 10, 16, SSD1306_BLACK);
+		displayLabel(10, 2, label_CONNECTED);
+		refreshDisplay();
+
+		// TODO Turn on the (blue) connected LED here
+
+		// Show the message before the status screen takes over
+		scheduler.runIn(TASK_DISPLAY, 1000);
+	} else
+	{
 #ifdef DEBUGMSG
-				Serial.println(F("Connected, but no heartbeat for 5 minutes"));
+		Serial.println(F("NOT CONNECTED."));
 #endif
-				lastHeartBeat = millis();
+		// TODO Do something with the connected LED here
+		displayNotConnected();
 
-				// TODO Do something with the heartbeat LED here
-			}
-		}
+		// The next phone has to negotiate afresh
+		btParser.discardPartial();
+		btParser.peerVersion = 1;
 	}
-	else
+}
+
+/* Collect the data the HC-06/05 has for us, as it arrives.
+ *
+ * First 8 bytes time in text format hh:MM:ss
+ *
+ * Then follows three variables of 3 bytes each in text format
+ * that contain the current battery level, the level at which the
+ * user wants to start charging and the level the user wants to
+ * stop charging
+ *
+ * The final byte is whether the phone is currently plugged in.
+ *
+ * If there has been no change to the battery level then a
+ * heartbeat is sent just so that this sketch knows the phone
+ * is still sending data down the line
+ *
+ * A phone that answered our HELLO sends the same as binary v2
+ * frames instead (see BTFrameParser.h)
+ */
+void btReceiveTask()
+{
+	// Discard a partial frame once the phone has gone quiet
+	if (btParser.pending() && millis() - lastBTByte >= btFrameGapMs)
 	{
-		// If we were previously connected but now are not
-		if (!prevStateDisconnected)
-		{
 #ifdef DEBUGMSG
-			Serial.println(F("NOT CONNECTED."));
+		Serial.print(F("Only received "));
+		Serial.print(btParser.pending());
+		Serial.println(F(" characters - ignored."));
 #endif
-			prevStateDisconnected = true;
+		btParser.discardPartial();
+	}
 
-			// TODO Do something with the connected LED here
-			displayNotConnected();
+	while (BTserial.available())
+	{
+		lastBTByte = millis();
+		if (btParser.feed(BTserial.read()))
+		{
+			processBTdata();
 		}
 	}
+}
 
-	// Give the data a chance to arrive
-	delay(100);
+// Sample the charge current into the rolling average: one run starts a
+// conversion, the next picks up its result
+void currentSampleTask()
+{
+	static bool converting = false;
+	static unsigned long started = 0;
+
+	// The INA219 is busy with a capture meanwhile: come back as it ends
+	if (capture.isRecording())
+	{
+		unsigned long elapsed = millis() - captureStarted;
+		converting = false;
+		scheduler.runIn(TASK_CURRENT,
+				elapsed < captureMs ? captureMs - elapsed + 1 : 1);
+		return;
+	}
+
+	if (!converting)
+	{
+		if (!chargingUp) return;
+		ina219.startConversion();
+		ina219Bus.request(micros() + ina219Cal::conversionMicros);
+		started = millis();
+		converting = true;
+		scheduler.runIn(TASK_CURRENT, ina219ConversionMs);
+		return;
+	}
+
+	if (!ina219.poll())
+	{
+		// Not ready yet; give up on it if charging has stopped meanwhile
+		if (chargingUp) scheduler.runIn(TASK_CURRENT, 1);
+		else converting = false;
+		return;
+	}
+	converting = false;
+
+	if (chargingUp)
+	{
+		chargemA = getMilliAmps();
+		taper.add(chargemA);
+	}
+
+	// Keep to one sample per period, however long this one took
+	unsigned long elapsed = millis() - started;
+	scheduler.runIn(TASK_CURRENT,
+			elapsed < currentSampleMs ? currentSampleMs - elapsed : 0);
 }
 
-// Print the first 8 characters - always the timestamp
-void printDateTimeStamp(char buffer[15]) {
-	static char dummy __attribute__ ((used)) = buffer[1];
-#ifdef DEBUGMSG
-	for (auto cnt = 0; cnt < 8; cnt++)
+// Send the phone one record for the samples since the last one
+void telemetryTask()
+{
+	// Only a phone that has negotiated v2 understands it
+	if (btParser.peerVersion < BT_VERSION) return;
+
+	// SoftwareSerial cannot receive while it sends, so wait for a gap
+	// between the phone's frames
+	if (BTserial.available() || btParser.pending()
+			|| millis() - lastBTByte < btFrameGapMs)
 	{
-		Serial.print((char) buffer[cnt]);
+		scheduler.runIn(TASK_TELEMETRY, btFrameGapMs);
+		return;
 	}
-	Serial.print(" ");
-#endif
+
+	uint32_t fields[9];
+	fields[0] = (isPluggedIn ? BT_FLAG_PLUGGED_IN : 0)
+			| (chargingUp ? BT_FLAG_CHARGING : 0);
+	fields[1] = telemetrySamples ? telemetrySum / telemetrySamples : 0;
+	fields[2] = telemetrySamples ? telemetryMin : 0;
+	fields[3] = telemetryMax;
+	fields[4] = chargeCounter.milliAmpHours();
+	fields[5] = btParser.goodFrames;
+	fields[6] = btParser.badFrames;
+	fields[7] = btParser.droppedFrames;
+	fields[8] = chargeCounter.milliWattHours();
+
+	uint8_t record[BT_MAX_PAYLOAD + 4];
+	BTserial.write(record, encodeBTFrame(record, BT_TELEMETRY, fields, 9));
+
+	telemetrySum = 0;
+	telemetrySamples = 0;
+	telemetryMin = 0xFFFF;
+	telemetryMax = 0;
 }
 
-// Display the extracted 3-character value buffer
-void displayBTbuffer()
+// Record the current at the full rate for a while after a switch
+void startCapture(uint8_t event)
 {
-#ifdef DEBUGMSG
-	Serial.print(" (");
-	for (auto cnt = 0; cnt < 3; cnt++)
+	capture.start(event);
+	ina219.configure(ina219CaptureCal::config
+			| INA219_CONFIG_MODE_SANDBVOLT_CONTINUOUS);
+	captureStarted = millis();
+	lastCaptureSample = micros();
+	ina219Bus.request(lastCaptureSample + ina219CaptureCal::conversionMicros);
+	scheduler.enable(TASK_CAPTURE);
+}
+
+void stopCapture()
+{
+	capture.stop();
+	scheduler.enable(TASK_CAPTURE, false);
+	ina219.configure(ina219Cal::config | INA219_CONFIG_MODE_SANDBVOLT_TRIGGERED);
+}
+
+// Read each conversion of a capture once it has had time to complete.
+// The current register alone will do: waiting on the conversion ready flag
+// as poll() does takes three reads a sample. The wait for the next one is
+// under a millisecond, too short for runIn(), so the task runs on every
+// pass and returns until it is over.
+void captureTask()
+{
+	unsigned long elapsed = micros() - lastCaptureSample;
+	if (elapsed < ina219CaptureCal::conversionMicros) return;
+
+	// Keep to the INA219's own conversion clock, however late this run is
+	unsigned long conversions = elapsed / ina219CaptureCal::conversionMicros;
+	lastCaptureSample += conversions * ina219CaptureCal::conversionMicros;
+
+	bool read = ina219.readCurrent();
+	ina219Bus.request(lastCaptureSample + ina219CaptureCal::conversionMicros);
+
+	if (read)
 	{
-		Serial.print(btValue[cnt]);
+		// Conversions that completed while other tasks ran
+		unsigned long missed = conversions - 1;
+		capture.add(ina219CaptureCal::milliAmps(ina219.current),
+				missed > 255 ? 255 : missed);
+	}
+
+	if (capture.isFull() || millis() - captureStarted >= captureMs)
+	{
+		stopCapture();
+	}
+}
+
+// Send the captures over Serial (on a 'c' from the Serial monitor) or to
+// the phone (when it asks), a little at a time and once none is being
+// made. A capture started meanwhile moves the others, so sending starts
+// again from the top.
+void captureDumpTask()
+{
+	if (Serial.available() && Serial.read() == 'c')
+	{
+		serialDumpAt = 0;
+		serialDumpCaptures = capture.captures;
+	}
+	if (btParser.captureRequested)
+	{
+		btParser.captureRequested = false;
+		btDumpAt = 0;
+		btDumpCaptures = capture.captures;
+	}
+
+	if (capture.isRecording()) return;
+
+	if (serialDumpAt >= 0)
+	{
+		if (serialDumpCaptures != capture.captures)
+		{
+			serialDumpAt = 0;
+			serialDumpCaptures = capture.captures;
+		}
+		serialDumpAt = printCapture(serialDumpAt);
+	}
+	if (btDumpAt >= 0)
+	{
+		if (btDumpCaptures != capture.captures)
+		{
+			btDumpAt = 0;
+			btDumpCaptures = capture.captures;
+		}
+		btDumpAt = sendCapture(btDumpAt);
 	}
-	Serial.println(")");
-#endif
 }
 
-// Extract the data element to check for heartbeat string
-bool extractHeartBeatFromBTdata(int startIdx, int endIdx)
+// Print the captures from 'pos' as text, about as much as goes out at
+// 9600 baud before the next run: mA of each sample, "mAxN" for N the same,
+// "+N" for N conversions missed. Returns where to carry on, -1 at the end.
+int16_t printCapture(int16_t pos)
+{
+	uint8_t printed = 0;
+	while (pos < (int16_t) capture.length() && printed < 40)
+	{
+		pos = capture.read(pos, serialDumpRecord);
+		switch (serialDumpRecord.kind)
 		{
+			case CAPTURE_START:
+				printed += Serial.print(serialDumpRecord.event == CAPTURE_ON ?
+						F("\r\nCAPTURE ON ") : F("\r\nCAPTURE OFF "));
+				printed += Serial.print(ina219CaptureCal::conversionMicros);
+				printed += Serial.println(F("uS"));
+				printed += Serial.print(serialDumpRecord.milliAmps);
+				break;
+
+			case CAPTURE_SAMPLES:
+				printed += Serial.print(' ');
+				printed += Serial.print(serialDumpRecord.milliAmps);
+				if (serialDumpRecord.count > 1)
+				{
+					printed += Serial.print('x');
+					printed += Serial.print(serialDumpRecord.count);
+				}
+				break;
+
+			case CAPTURE_GAP:
+				printed += Serial.print(F(" +"));
+				printed += Serial.print(serialDumpRecord.count);
+				break;
+		}
+	}
+	if (pos < (int16_t) capture.length()) return pos;
+	Serial.println();
+	Serial.println(F("END"));
+	return -1;
+}
+
+// Send the phone the next piece of the captures from 'pos' as they are
+// held; returns where to carry on, -1 at the end
+int16_t sendCapture(int16_t pos)
+{
+	if (btParser.peerVersion < BT_VERSION) return -1;
 
-	int hbIdx = 0;
-	memset(heartBeat, '\0', sizeof(heartBeat));
-	for (auto cnt = startIdx; cnt <= endIdx; cnt++)
+	// As for telemetry, wait for a gap between the phone's frames
+	if (BTserial.available() || btParser.pending()
+			|| millis() - lastBTByte < btFrameGapMs)
 	{
-		heartBeat[hbIdx++] = buffer[cnt];
+		return pos;
 	}
 
-//	Serial.print("Heartbeat buffer:");
-//	for (auto cnt = 0; cnt < 9; cnt++)
-//	{
-//		Serial.print(heartBeat[cnt]);
-//	}
+	uint32_t fields[12];
+	uint8_t count = 0;
+	fields[count++] = pos;
+	fields[count++] = capture.length();
+	while (count < 12 && pos < (int16_t) capture.length())
+	{
+		fields[count++] = capture.at(pos++);
+	}
 
-	char key[] = "HEARTBEAT";
-	if (strcmp(heartBeat, key) == 0)
+	uint8_t chunk[BT_MAX_PAYLOAD + 4];
+	BTserial.write(chunk, encodeBTFrame(chunk, BT_CAPTURE, fields, count));
+	return pos < (int16_t) capture.length() ? pos : -1;
+}
+
+// Rotate between charge current, the session's totals (once there are
+// any) and battery level
+void displayTask()
+{
+	static uint8_t displayCharge = 0;
+
+	if (displayCharge == 5)
+	{
+		displayCharge = 0;
+		displayBatteryPercent();
+		return;
+	}
+
+	if (displayCharge >= 3 && chargeCounter.milliAmpHours())
 	{
-		return true;
+		displaySessionTotals();
 	} else
 	{
-		return false;
+		displayChargeStatus(chargingUp);
 	}
+	displayCharge++;
 }
 
-// Extract the 3-digit value from the string BT data
-int extractDataFromBTdata(int startIdx, int endIdx)
-		{
+// Check last heartbeat
+void heartbeatTimeoutTask()
+{
+	// See http://www.gammon.com.au/millis on why we do it this way
+	if (millis() - lastHeartBeat >= 300000UL)
+	{
+#ifdef DEBUGMSG
+		Serial.println(F("Connected, but no heartbeat for 5 minutes"));
+#endif
+		lastHeartBeat = millis();
 
-	// Clear the target buffer and ensure last (4th) char
-	// is a null terminator 0
-	memset(btValue, 0, sizeof(btValue));
+		// TODO Do something with the heartbeat LED here
+	}
+}
 
-	int btValueIdx = 0;
-	for (auto cnt = startIdx; cnt <= endIdx; cnt++)
+// Send the changed parts of the screen, a little at a time
+void displayFlushTask()
+{
+	if (display.flushStep(2000))
 	{
-		btValue[btValueIdx++] = buffer[cnt];
+		scheduler.enable(TASK_DISPLAY_FLUSH, false);
 	}
+}
 
-	// Convert the 'string' to an integer
-	int returnValue = atoi(btValue);
-	return returnValue;
+// Start sending the screen buffer to the display
+void refreshDisplay()
+{
+	display.beginFlush();
+	scheduler.enable(TASK_DISPLAY_FLUSH);
+}
+
+// Print the first 8 characters - always the timestamp
+void printDateTimeStamp(char buffer[15]) {
+	static char dummy __attribute__ ((used)) = buffer[1];
+#ifdef DEBUGMSG
+	for (auto cnt = 0; cnt < 8; cnt++)
+	{
+		Serial.print((char) buffer[cnt]);
+	}
+	Serial.print(" ");
+#endif
 }
 
 // What's coming in the BT serial buffer?
@@ -495,64 +947,52 @@ void pluggedInStatus()
 	}
 }
 
-// Display beating heart symbol indicating HeartBeat is active
-void displayHeartBeat()
+// Display beating heart symbol indicating HeartBeat is active. The heart
+// has the columns left of the text to itself, and only the two pages it
+// is drawn on are sent, straight away: 20 bytes a beat rather than
+// waiting on (or adding to) the text's flush.
+void displayHeartBeat(bool show)
 {
-	// TODO beating heart
 	const int startPos = 8;
-
-	// Display the heart
-	display.setTextSize(2);
-	display.setTextColor(SSD1306_WHITE);
-	display.setCursor(0, startPos);	// x,y Start at top-left corner
-	display.write(3);
-	display.display();
-	delay(200);
+	const int heartWidth = 10;  // The text starts to the right of this
+	const int heartHeight = 16; // Size 2 glyph
 
 	// Clear the heart
-	display.fillRect(0, 0, 10, display.height(), SSD1306_BLACK);
-	display.display();
-	delay(200);
+	display.fillRect(0, startPos, heartWidth, heartHeight, SSD1306_BLACK);
 
-	// Display the heart
-	display.setTextSize(2);
-	display.setTextColor(SSD1306_WHITE);
-	display.setCursor(0, startPos);	// x,y Start at top-left corner
-	display.write(3);
-	display.display();
+	if (show)
+	{
+		// Display the heart
+		display.setTextSize(2);
+		display.setTextColor(SSD1306_WHITE);
+		display.setCursor(0, startPos);	// x,y Start at top-left corner
+		display.write(3);
+	}
+	display.displayRegion(0, startPos, heartWidth, heartHeight);
 }
 
-void INA219_setup()
+// Beat the heart: shown for 400mS, blanked for 200mS
+void heartbeatAnimationTask()
 {
-	// Initialise I2C (default address of 0x40)
-	Wire.begin();
-
-	// Test that we can communicate with the device
-	Wire.beginTransmission(hexAddress);
+	static bool heartShown = false;
 
-	// Set the calibration to 32V @2A by writing two bytes (4096, an int) to that register
-	Wire.write(INA219_REG_CALIBRATION);
-	Wire.write((4096 >> 8) & 0xFF);
-	Wire.write(4096 & 0xFF);
-
-	Wire.endTransmission();
+	heartShown = !heartShown;
+	displayHeartBeat(heartShown);
+	scheduler.runIn(TASK_HEARTBEAT_ANIMATION, heartShown ? 400 : 200);
+}
 
-	// Config
-	Wire.beginTransmission(hexAddress);
-	Wire.write(INA219_REG_CONFIG);
+void INA219_setup()
+{
+	// Initialise I2C (default address of 0x40)
+	i2cBus.begin();
+	ina219.setBus(&ina219Bus);
 
 	// Set Config register stating we want:
-	uint16_t config = INA219_CONFIG_BVOLTAGERANGE_32V   // 32 volt, 2A range
-						| INA219_CONFIG_GAIN_8_320MV   // 8 x Gain
-						| INA219_CONFIG_BADCRES_12BIT   // 12-bit bus ADC resolution
-						| INA219_CONFIG_SADCRES_12BIT_8S_4260US   // number of averaged samples
-						| INA219_CONFIG_MODE_SANDBVOLT_CONTINUOUS;   // Continuouis conversion
-	Wire.write((config >> 8) & 0xFF);
-	Wire.write(config & 0xFF);
-
-	// See if something acknowledged the transmission
-	response = Wire.endTransmission();
-	if (response == 0)
+	uint16_t config = ina219Cal::config   // 32 volt range, gain and averaging
+						| INA219_CONFIG_MODE_SANDBVOLT_TRIGGERED;   // Convert when asked
+
+	// Set the calibration and see if something acknowledged it
+	if (ina219.begin(ina219Cal::calibration, config))
 	{
 #ifdef DEBUGMSG
 		Serial.print(F("I2C device found at hexAddress 0x"));
@@ -561,10 +1001,10 @@ void INA219_setup()
 		Serial.println(hexAddress, HEX);
 #endif
 	}
-	else if (response == 4) // unknown error
+	else
 	{
 #ifdef DEBUGMSG
-		Serial.print(F("Unknown response at hexAddress 0x"));
+		Serial.print(F("No response at hexAddress 0x"));
 		if (hexAddress < 16)
 		Serial.print("0");
 		Serial.println(hexAddress, HEX);
@@ -577,45 +1017,34 @@ void INA219_setup()
 #endif
 }
 
-int getMilliAmps()
+// Does the INA219 still read back what INA219_setup() wrote?
+bool checkINA219()
 {
-	// Adafruit say the INA219 can be reset by sharp current loads so always recalbrate
-	Wire.beginTransmission(hexAddress);
-	Wire.write(INA219_REG_CALIBRATION);
-	Wire.write((4096 >> 8) & 0xFF);
-	Wire.write(4096 & 0xFF);
-	Wire.endTransmission();
-
-	// Initiate transmission to the device we want
-	Wire.beginTransmission(hexAddress);
-
-	// Tell device the register we want to write to (Current)
-	Wire.write(INA219_REG_CURRENT);
-
-	// Finish this "conversation"
-	Wire.endTransmission();
-
-	// Initiate transmission to the device we want
-	Wire.beginTransmission(hexAddress);
-
-	// Request the value (current in mA) two bytes
-	Wire.requestFrom((int) hexAddress, 2);
+	return ina219.verify();
+}
 
-	// Finish this conversation
-	Wire.endTransmission();
+// Does the display acknowledge a command?
+bool checkDisplay()
+{
+	return display.ping();
+}
 
-	// delay required to allow INA219 to do the conversion (see samples)
-	delayMicroseconds(4260);
+// Current from the INA219's latest reading, into the rolling average
+int getMilliAmps()
+{
+	// Display the current being consumed, less the LED's
+	int current = ina219Cal::milliAmps(ina219.current) - ledMilliAmps;
+	current = current < 0 ? 0 : current;
 
-	// Shift values to create properly formed integer
-	// Note that no "conversation" start/end is required for a read
-	// as the device is expecting this from the prep done above
-	uint16_t value = ((Wire.read() << 8) | Wire.read());
+	// For the next telemetry record
+	telemetrySum += current;
+	telemetrySamples++;
+	if ((uint16_t) current < telemetryMin) telemetryMin = current;
+	if ((uint16_t) current > telemetryMax) telemetryMax = current;
 
-	// Display the current being consumed
-	// Current LSB = 100uA per bit (1000/100 = 10)
-	int current = (value / 10) - 16; // LED takes 16mA
-	current = current < 0 ? 0 : current;
+	long power = (long) ina219Cal::milliWatts(ina219.power)
+			- ledPower::apply(ina219.bus);
+	chargeCounter.add(ina219.sampledAt, current, power < 0 ? 0 : power);
 
 	//Serial.print(F("Current (mA):"));
 	//Serial.println(current);
@@ -633,25 +1062,12 @@ int getMilliAmps()
 		Serial.println(current);
 #endif
 		firstCharge = false;
-		for (uint8_t cnt = 0; cnt < (sizeof(mA_Average) / 2); cnt++)
-		{
-			mA_Average[cnt] = current;
-		}
+		mAMedian.fill(current);
+		mAAverage.fill(current);
 	}
 
 	// Send back averaged response
-	uint8_t numberOfAverages = (sizeof(mA_Average) / 2) - 1;
-	mA_Average[mAIdx] = current;
-	mAIdx++;
-	mAIdx = mAIdx > numberOfAverages ? 0 : mAIdx;
-
-	uint16_t rollingAverage = 0;
-	for (auto cnt = 0; cnt < numberOfAverages; cnt++)
-	{
-		rollingAverage += mA_Average[cnt];
-	}
-
-	return rollingAverage / numberOfAverages;
+	return mAAverage.add(mAMedian.add(current));
 }
 
 void displayBatteryPercent()
@@ -660,28 +1076,22 @@ void displayBatteryPercent()
 	display.fillRect(10, 0, display.width() - 10, display.height(), SSD1306_BLACK);
 
 	// Write the message
+	displayLabel(32, 0, label_CHARGE);
 	display.setTextSize(2);
 	display.setTextColor(SSD1306_WHITE);
-	display.setCursor(32, 1);   // x,y
-	display.print("CHARGE");
 	display.setCursor(50, 18);   // x,y
 	display.print(batLevel);
 	display.print("%");
-	display.display();
+	refreshDisplay();
 }
 
 void displayNotConnected() {
 	display.clearDisplay();
-	display.display();
 
-	display.setTextSize(2);
-	display.setTextColor(SSD1306_WHITE);
-	display.setCursor(50, 1);   // x,y
-	display.print("NOT");
-	display.setCursor(10, 18);   // x,y
-	display.print("CONNECTED");
+	displayLabel(50, 0, label_NOT);
+	displayLabel(10, 2, label_CONNECTED);
 
-	display.display();
+	refreshDisplay();
 }
 
 void displayChargeStatus(bool charging)
@@ -694,21 +1104,36 @@ void displayChargeStatus(bool charging)
 	display.setTextColor(SSD1306_WHITE);
 	if (charging)
 	{
-		int chargemA = getMilliAmps();
-		display.setCursor(32, 1);   // x,y
-		display.print("CHARGE");
+		displayLabel(32, 0, label_CHARGE);
 		display.setCursor(40, 18);   // x,y
 		display.print(chargemA);
 		display.print("mA");
 	} else
 	{
 		//display.setCursor(20, 16);   // x,y
-		display.setCursor(32, 1);   // x,y
-		display.print("PAUSED");
+		displayLabel(32, 0, label_PAUSED);
 		display.setCursor(50, 18);   // x,y
 		display.print(batLevel);
 		display.print("%");
 	}
 
-	display.display();
+	refreshDisplay();
+}
+
+// Charge and energy delivered since the phone connected
+void displaySessionTotals()
+{
+	// clear area of screen (leave heartbeat alone)
+	display.fillRect(10, 0, display.width() - 10, display.height(), SSD1306_BLACK);
+
+	display.setTextSize(2);
+	display.setTextColor(SSD1306_WHITE);
+	display.setCursor(20, 0);   // x,y
+	display.print(chargeCounter.milliAmpHours());
+	display.print("mAh");
+	display.setCursor(20, 18);   // x,y
+	display.print(chargeCounter.milliWattHours());
+	display.print("mWh");
+
+	refreshDisplay();
 }
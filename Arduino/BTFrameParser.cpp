@@ -0,0 +1,295 @@
+#include "BTFrameParser.h"
+
+// Highest digit allowed at each position of "hh:MM:ss", ':' for the
+// separators
+static const char timeShape[8] = { '2', '9', ':', '5', '9', ':', '5', '9' };
+
+static const char heartbeatText[] = "HEARTBEAT";
+
+// Digits at p as a number, or 0xFF if one of them is not a digit or the
+// number is above max
+static inline uint8_t decimal(const char *p, uint8_t digits, uint8_t max)
+{
+	uint8_t value = 0;
+	while (digits--)
+	{
+		uint8_t d = (uint8_t) (*p++ - '0');
+		if (d > 9) return 0xFF;
+		value = value * 10 + d;
+	}
+	return value > max ? 0xFF : value;
+}
+
+BTFrameParser::BTFrameParser(char *frame) :
+		goodFrames(0), badFrames(0), droppedFrames(0), version(1),
+		captureRequested(false), peerVersion(1), frame(frame), head(0),
+		count(0), binCount(0), inBinary(false)
+{
+}
+
+// Number of bytes at the head of the ring that can still be the start of
+// a frame (all of them when everything so far fits the frame shape)
+uint8_t BTFrameParser::validPrefix()
+{
+	for (uint8_t idx = 0; idx < count; idx++)
+	{
+		char c = at(idx);
+		bool ok;
+
+		if (idx < 8)
+		{
+			// Timestamp
+			if (timeShape[idx] == ':') ok = c == ':';
+			else ok = c >= '0' && c <= timeShape[idx];
+		} else if (idx < 17)
+		{
+			// Either the heartbeat text or three values of 0 - 100
+			if (at(8) == 'H')
+			{
+				ok = c == heartbeatText[idx - 8];
+			} else
+			{
+				uint8_t digit = (idx - 8) % 3;
+				char first = at(idx - digit);
+				if (digit == 0) ok = c == '0' || c == '1';
+				else if (first == '1') ok = c == '0';
+				else ok = c >= '0' && c <= '9';
+			}
+		} else
+		{
+			// Plugged in flag
+			ok = c == '0' || c == '1';
+		}
+
+		if (!ok) return idx;
+	}
+	return count;
+}
+
+bool BTFrameParser::feed(char c)
+{
+	if (inBinary) return feedBinary(c);
+
+	// The sync byte never appears in a text frame
+	if ((uint8_t) c == BT_SYNC)
+	{
+		if (count) droppedFrames++;
+		count = 0;
+		binCount = 0;
+		inBinary = true;
+		return false;
+	}
+
+	// Line endings only ever separate frames
+	if ((c == '\r' || c == '\n') && count == 0) return false;
+
+	if (count == ringSize)
+	{
+		// Cannot happen while every prefix is checked, but never overrun
+		head = (head + 1) & (ringSize - 1);
+		count--;
+	}
+	ring[(head + count) & (ringSize - 1)] = c;
+	count++;
+
+	// Resynchronise: drop bytes from the head until what is left could
+	// still be (the start of) a frame
+	uint8_t valid;
+	while ((valid = validPrefix()) < count)
+	{
+		if (valid >= 8) badFrames++;
+		head = (head + 1) & (ringSize - 1);
+		count--;
+	}
+
+	if (count < BT_FRAME_LENGTH) return false;
+
+	for (uint8_t idx = 0; idx < BT_FRAME_LENGTH; idx++)
+	{
+		frame[idx] = at(idx);
+	}
+	frame[BT_FRAME_LENGTH] = '\0';
+	head = (head + BT_FRAME_LENGTH) & (ringSize - 1);
+	count -= BT_FRAME_LENGTH;
+	goodFrames++;
+	version = 1;
+	return true;
+}
+
+bool BTFrameParser::feedBinary(uint8_t c)
+{
+	bin[binCount++] = c;
+
+	if (binCount == 1 && (c >> 4) != BT_VERSION)
+	{
+		// Not a frame after all: the byte may still start a text frame
+		inBinary = false;
+		badFrames++;
+		return feed(c);
+	}
+	if (binCount == 2 && c > BT_MAX_PAYLOAD)
+	{
+		inBinary = false;
+		badFrames++;
+		return false;
+	}
+	if (binCount < 3 || binCount < bin[1] + 3) return false;
+	inBinary = false;
+
+	uint8_t crc = 0;
+	for (uint8_t idx = 0; idx < binCount - 1; idx++)
+	{
+		crc = crc8Update(crc, bin[idx]);
+	}
+	if (crc != bin[binCount - 1] || !decodeBinary())
+	{
+		badFrames++;
+		return false;
+	}
+	goodFrames++;
+
+	// Only levels and heartbeats are for the sketch
+	uint8_t type = bin[0] & 0x0F;
+	if (type != BT_LEVELS && type != BT_HEARTBEAT) return false;
+	version = 2;
+	return true;
+}
+
+// Check the fields of the v2 frame in 'bin' and store them in 'decoded'
+bool BTFrameParser::decodeBinary()
+{
+	uint32_t fields[5] = { 0 };
+	uint8_t fieldCount = 0;
+	uint8_t shift = 0;
+	const uint8_t *end = bin + 2 + bin[1];
+	for (const uint8_t *p = bin + 2; p < end; p++)
+	{
+		if (shift > 28) return false;
+		if (fieldCount < 5)
+		{
+			fields[fieldCount] |= (uint32_t) (*p & 0x7F) << shift;
+		}
+		shift += 7;
+		if (!(*p & 0x80))
+		{
+			fieldCount++;
+			shift = 0;
+		}
+	}
+	if (shift) return false;
+
+	switch (bin[0] & 0x0F)
+	{
+		case BT_HELLO:
+			if (fieldCount < 1 || fields[0] < 1) return false;
+			peerVersion = fields[0] < BT_VERSION ? fields[0] : BT_VERSION;
+			return true;
+
+		case BT_LEVELS:
+			if (fieldCount < 4 || fields[1] > 100 || fields[2] > 100
+					|| fields[3] > 100 || fields[4] >= 86400UL) return false;
+			decoded.heartbeat = 0;
+			decoded.battery = fields[1];
+			decoded.maxCharge = fields[2];
+			decoded.minCharge = fields[3];
+			break;
+
+		case BT_CAPTURE:
+			captureRequested = true;
+			return true;
+
+		case BT_HEARTBEAT:
+			if (fieldCount < 1 || fields[1] >= 86400UL) return false;
+			decoded.heartbeat = 1;
+			decoded.battery = decoded.maxCharge = decoded.minCharge = 0;
+			fields[4] = fields[1];
+			break;
+
+		default:
+			// From a later version: well formed, but nothing for us
+			return true;
+	}
+	decoded.pluggedIn = fields[0] & BT_FLAG_PLUGGED_IN;
+	decoded.seconds = fields[4];
+	return true;
+}
+
+void BTFrameParser::discardPartial()
+{
+	if (count || inBinary) droppedFrames++;
+	count = 0;
+	inBinary = false;
+}
+
+bool decodeBTFrame(const char *buffer, BTFrame &frame)
+{
+	uint8_t hours = decimal(buffer, 2, 23);
+	uint8_t minutes = decimal(buffer + 3, 2, 59);
+	uint8_t seconds = decimal(buffer + 6, 2, 59);
+	if (hours == 0xFF || minutes == 0xFF || seconds == 0xFF
+			|| buffer[2] != ':' || buffer[5] != ':') return false;
+	frame.seconds = (hours * 60U + minutes) * 60UL + seconds;
+
+	uint8_t plugged = (uint8_t) (buffer[17] - '0');
+	if (plugged > 1) return false;
+	frame.pluggedIn = plugged;
+
+	if (buffer[8] == 'H')
+	{
+		for (uint8_t idx = 1; idx < 9; idx++)
+		{
+			if (buffer[8 + idx] != heartbeatText[idx]) return false;
+		}
+		frame.heartbeat = 1;
+		frame.battery = frame.maxCharge = frame.minCharge = 0;
+		return true;
+	}
+
+	uint8_t battery = decimal(buffer + 8, 3, 100);
+	uint8_t maxCharge = decimal(buffer + 11, 3, 100);
+	uint8_t minCharge = decimal(buffer + 14, 3, 100);
+	if (battery == 0xFF || maxCharge == 0xFF || minCharge == 0xFF)
+		return false;
+	frame.heartbeat = 0;
+	frame.battery = battery;
+	frame.maxCharge = maxCharge;
+	frame.minCharge = minCharge;
+	return true;
+}
+
+uint8_t crc8Update(uint8_t crc, uint8_t data)
+{
+	crc ^= data;
+	for (uint8_t bit = 0; bit < 8; bit++)
+	{
+		crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+	}
+	return crc;
+}
+
+uint8_t encodeBTFrame(uint8_t *out, uint8_t type, const uint32_t *fields,
+		uint8_t count)
+{
+	uint8_t length = 3;
+	for (uint8_t idx = 0; idx < count; idx++)
+	{
+		uint32_t value = fields[idx];
+		do
+		{
+			uint8_t low = value & 0x7F;
+			value >>= 7;
+			out[length++] = value ? low | 0x80 : low;
+		} while (value);
+	}
+	out[0] = BT_SYNC;
+	out[1] = BT_VERSION << 4 | type;
+	out[2] = length - 3;
+
+	uint8_t crc = 0;
+	for (uint8_t idx = 1; idx < length; idx++)
+	{
+		crc = crc8Update(crc, out[idx]);
+	}
+	out[length++] = crc;
+	return length;
+}
@@ -0,0 +1,122 @@
+// Incremental parser for the 18-byte frames sent by the phone app
+//
+// Bytes are fed one at a time as they come off the Bluetooth serial link.
+// A frame is recognised by its shape rather than by its position in the
+// byte stream, so a lost or corrupted byte only costs that one frame:
+//
+//   hh:MM:ss  then  HEARTBEAT  or  battery max min (3 digits each, 0-100)
+//   then the plugged in flag, 0 or 1
+//
+// CR/LF delimiters between frames are skipped.
+//
+// decodeBTFrame() then turns a frame into numbers in a single pass.
+//
+// Protocol v2 is binary; the charger offers it with a HELLO when the phone
+// connects and the phone answers with a HELLO of its own if it speaks it:
+//
+//   sync 0xA5, version << 4 | type, length, 'length' bytes of fields, CRC
+//
+// The fields are unsigned LEB128 varints in a fixed order for each type
+// and trailing ones may be left out. The CRC-8 (polynomial 0x07, starting
+// at 0) covers everything after the sync byte. Text frames are accepted
+// throughout, so a phone that ignores the HELLO carries on as before.
+
+#ifndef _BTFRAMEPARSER_H_
+#define _BTFRAMEPARSER_H_
+#include "Arduino.h"
+
+#define BT_FRAME_LENGTH 18
+
+#define BT_SYNC 0xA5
+#define BT_VERSION 2
+#define BT_MAX_PAYLOAD 24
+
+// v2 frame types and their fields
+#define BT_HELLO 0     // highest version supported
+#define BT_LEVELS 1    // flags, battery, max, min [, seconds since midnight]
+#define BT_HEARTBEAT 2 // flags [, seconds since midnight]
+#define BT_TELEMETRY 3 // From the charger: flags, average/min/max mA,
+                       // mAh delivered, the parser's good, bad and
+                       // dropped frame counts, mWh delivered
+#define BT_CAPTURE 4   // From the phone: send the transient captures (no
+                       // fields). From the charger: offset, total length,
+                       // then up to 10 bytes of them (see TransientCapture.h)
+
+#define BT_FLAG_PLUGGED_IN 0x01
+#define BT_FLAG_CHARGING 0x02
+
+// Contents of one frame, 5 bytes
+struct BTFrame
+{
+	uint32_t seconds :17;  // Timestamp as seconds since midnight
+	uint32_t battery :7;   // Battery level %, 0 - 100
+	uint32_t maxCharge :7; // Stop charging at this level %
+	uint32_t pluggedIn :1; // Phone says it is on charge
+	uint8_t minCharge :7;  // Start charging at this level %
+	uint8_t heartbeat :1;  // Heartbeat frame: no levels, all zero
+}__attribute__((packed));
+
+// Decode a frame in place; returns false if a field is out of range
+bool decodeBTFrame(const char *buffer, BTFrame &frame);
+
+// CRC-8 of v2 frames, one byte at a time
+uint8_t crc8Update(uint8_t crc, uint8_t data);
+
+// Build a v2 frame in 'out' (BT_MAX_PAYLOAD + 4 bytes) and return its
+// length; the fields must fit in BT_MAX_PAYLOAD bytes
+uint8_t encodeBTFrame(uint8_t *out, uint8_t type, const uint32_t *fields,
+		uint8_t count);
+
+class BTFrameParser
+{
+	public:
+		// Complete frames are copied to 'frame' (BT_FRAME_LENGTH + 1 chars,
+		// null terminated)
+		BTFrameParser(char *frame);
+
+		// Add a received byte; returns true when it completed a frame:
+		// text frames are then in 'frame', v2 frames in 'decoded'
+		bool feed(char c);
+
+		// Throw away a partial frame, e.g. once the link has gone quiet
+		void discardPartial();
+
+		// Bytes waiting for the rest of their frame
+		uint8_t pending()
+		{
+			return inBinary ? count + binCount + 1 : count;
+		}
+
+		uint16_t goodFrames;    // Complete, well formed frames
+		uint16_t badFrames;     // Bad payload, length or CRC
+		uint16_t droppedFrames; // Partial frames discarded
+
+		uint8_t version;     // Of the last frame: 1 text, 2 binary
+		bool captureRequested; // The phone has asked for the captures
+		uint8_t peerVersion; // Highest the phone has offered, 1 until a HELLO
+		BTFrame decoded;     // Last v2 frame
+
+	private:
+		// Power of two, at least one frame long
+		static const uint8_t ringSize = 32;
+
+		char at(uint8_t idx)
+		{
+			return ring[(head + idx) & (ringSize - 1)];
+		}
+		uint8_t validPrefix();
+		bool feedBinary(uint8_t c);
+		bool decodeBinary();
+
+		char *frame;
+		char ring[ringSize];
+		uint8_t head;
+		uint8_t count;
+
+		// v2 frame after the sync byte: version/type, length, fields, CRC
+		uint8_t bin[BT_MAX_PAYLOAD + 3];
+		uint8_t binCount;
+		bool inBinary;
+};
+
+#endif /* _BTFRAMEPARSER_H_ */
@@ -0,0 +1,97 @@
+// Battery level between the phone's reports
+//
+// The phone only says its level when it changes, and may not manage even
+// that (a lost frame, a sleeping app), so charging could run on past
+// maxCharge until the next report. Instead the level is projected from the
+// last report and the charge delivered since, using the phone's capacity
+// as seen from the charger: mAh delivered per 100%, learned while charging
+// from the charge it takes to gain each few percent. That includes what
+// the phone uses itself meanwhile, which is what the projection needs.
+//
+// Learning starts afresh for each phone; until it has a capacity the
+// estimator never projects, and it never runs more than maxAhead percent
+// ahead of the phone's last report.
+
+#ifndef _BATTERYESTIMATOR_H_
+#define _BATTERYESTIMATOR_H_
+#include "Arduino.h"
+
+class BatteryEstimator
+{
+	public:
+		BatteryEstimator()
+		{
+			reset();
+		}
+
+		// A new phone
+		void reset()
+		{
+			capacity = 0;
+			lastLevel = 0;
+			lastmAh = 0;
+			anchored = false;
+		}
+
+		// A level report from the phone, with the charge delivered so far
+		void report(uint8_t level, uint32_t mAh, bool charging)
+		{
+			lastLevel = level;
+			lastmAh = mAh;
+
+			if (!charging)
+			{
+				// The phone has been on its own battery: start again
+				anchored = false;
+				return;
+			}
+			if (!anchored)
+			{
+				anchored = true;
+				anchorLevel = level;
+				anchormAh = mAh;
+				return;
+			}
+			if (level >= anchorLevel + learnSpan)
+			{
+				uint32_t span = (mAh - anchormAh) * 100 / (level - anchorLevel);
+				capacity = capacity ? (capacity * 3 + span) / 4 : span;
+				anchorLevel = level;
+				anchormAh = mAh;
+			}
+		}
+
+		// Has the battery reached 'target' % now that 'mAh' has been
+		// delivered? Only answers yes from an estimate while charging.
+		bool reached(uint8_t target, uint32_t mAh) const
+		{
+			if (!capacity || !anchored || target <= lastLevel) return false;
+			if (target - lastLevel > maxAhead) return false;
+
+			// (mAh - lastmAh) / capacity x 100 >= target - lastLevel
+			return (mAh - lastmAh) * 100
+					>= (uint32_t) (target - lastLevel) * capacity;
+		}
+
+		// Projected level, % (the last report until a capacity is known)
+		uint8_t level(uint32_t mAh) const
+		{
+			if (!capacity || !anchored) return lastLevel;
+			uint32_t gained = (mAh - lastmAh) * 100 / capacity;
+			return lastLevel + (gained > maxAhead ? maxAhead : gained);
+		}
+
+		uint32_t capacity; // mAh per 100%, 0 until learned
+
+	private:
+		static const uint8_t learnSpan = 5; // % between capacity samples
+		static const uint8_t maxAhead = 20; // % beyond the last report
+
+		uint8_t lastLevel;
+		uint32_t lastmAh;
+		uint8_t anchorLevel;
+		uint32_t anchormAh;
+		bool anchored;
+};
+
+#endif /* _BATTERYESTIMATOR_H_ */
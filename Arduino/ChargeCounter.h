@@ -0,0 +1,94 @@
+// Charge and energy delivered, integrated from current and power readings
+//
+// Each reading counts for the time since the one before it, from the
+// micros() it was taken at (not when it was processed), so the totals stay
+// right whatever the sampling rate. Time is
+// counted in ticks of 1024uS: an mAh is then exactly 3515625 mA ticks, so
+// the part-used mAh and mWh are plain 32-bit sums with no division, cheap
+// enough for every INA219 conversion.
+
+#ifndef _CHARGECOUNTER_H_
+#define _CHARGECOUNTER_H_
+#include "Arduino.h"
+
+class ChargeCounter
+{
+	public:
+		ChargeCounter()
+		{
+			reset();
+		}
+
+		// Start a new session
+		void reset()
+		{
+			mAh = 0;
+			mWh = 0;
+			chargeTicks = 0;
+			energyTicks = 0;
+			running = false;
+		}
+
+		// No readings for a while (charging switched off): the next one
+		// starts afresh instead of covering the gap
+		void pause()
+		{
+			running = false;
+		}
+
+		// Add a reading taken at 'now' micros()
+		void add(unsigned long now, uint16_t milliAmps, uint16_t milliWatts)
+		{
+			if (running)
+			{
+				unsigned long elapsed = now - last + leftover;
+				uint32_t ticks = elapsed >> 10;
+				leftover = elapsed & 1023;
+
+				// Keeps milliWatts x ticks within 31 bits
+				if (ticks > maxTicks) ticks = maxTicks;
+
+				chargeTicks += (uint32_t) milliAmps * ticks;
+				while (chargeTicks >= ticksPerHour)
+				{
+					chargeTicks -= ticksPerHour;
+					mAh++;
+				}
+				energyTicks += (uint32_t) milliWatts * ticks;
+				while (energyTicks >= ticksPerHour)
+				{
+					energyTicks -= ticksPerHour;
+					mWh++;
+				}
+			} else
+			{
+				leftover = 0;
+				running = true;
+			}
+			last = now;
+		}
+
+		uint32_t milliAmpHours() const
+		{
+			return mAh;
+		}
+
+		uint32_t milliWattHours() const
+		{
+			return mWh;
+		}
+
+	private:
+		static const uint32_t ticksPerHour = 3515625UL; // 3600s / 1024uS
+		static const uint32_t maxTicks = 32768;         // 33.5 seconds
+
+		uint32_t mAh;
+		uint32_t mWh;
+		uint32_t chargeTicks; // mA ticks short of the next mAh
+		uint32_t energyTicks; // mW ticks short of the next mWh
+		unsigned long last;
+		uint16_t leftover;    // uS short of the next tick
+		bool running;
+};
+
+#endif /* _CHARGECOUNTER_H_ */
@@ -0,0 +1,198 @@
+// Small fixed-size filters for sensor samples
+//
+// Each keeps its state in place and updates in constant time (the median
+// in O(log N) plus a short move), and none of them divides: averages over
+// a power of two N are a shift, any other N two multiplies by a 16-bit
+// reciprocal (the second on the remainder) and one correction step,
+// exact for any sum of N 16-bit samples.
+//
+//   Boxcar<T, N>  mean of the last N samples, from a running sum
+//   Ema<T, N>     exponential moving average with weight 1/N, N a power of 2
+//   Median<T, N>  median of the last N samples, for spikes and jitter
+
+#ifndef _FILTERS_H_
+#define _FILTERS_H_
+#include "Arduino.h"
+#include <stddef.h>
+
+namespace FilterMath
+{
+	constexpr uint8_t log2(size_t n)
+	{
+		return n > 1 ? 1 + log2(n / 2) : 0;
+	}
+
+	// sum / N, rounded down
+	template<size_t N>
+	struct Divide
+	{
+		static const bool powerOfTwo = N && !(N & (N - 1));
+		static const uint8_t shift = log2(N);
+
+		// sum * reciprocal stays within 32 bits while the sum is the total
+		// of N values of at most 16 bits
+		static const uint32_t reciprocal = 65536UL / N;
+
+		static uint32_t apply(uint32_t sum)
+		{
+			if (powerOfTwo) return sum >> shift;
+
+			// The reciprocal is rounded down, so this can be up to N short
+			// (sum / 65536 + 1), leaving a remainder under N * (N + 1)...
+			uint32_t quotient = (sum * reciprocal) >> 16;
+			uint32_t remainder = sum - quotient * N;
+
+			// ...which is below 65536, so the same estimate of it is at
+			// most one short
+			uint32_t more = (remainder * reciprocal) >> 16;
+			quotient += more;
+			if (remainder - more * N >= N) quotient++;
+			return quotient;
+		}
+	};
+}
+
+template<typename T, size_t N>
+class Boxcar
+{
+	public:
+		static_assert(N > 0 && N < 256, "Boxcar length must be 1 - 255");
+		static_assert(sizeof(T) <= 2 && (T) -1 > 0,
+				"Boxcar sums unsigned 8 or 16-bit samples");
+
+		Boxcar() :
+				sum(0), idx(0)
+		{
+			fill(0);
+		}
+
+		// Start over as if every sample so far had been 'value'
+		void fill(T value)
+		{
+			for (uint8_t cnt = 0; cnt < N; cnt++)
+			{
+				slots[cnt] = value;
+			}
+			sum = (uint32_t) value * N;
+			idx = 0;
+		}
+
+		T add(T sample)
+		{
+			sum += sample;
+			sum -= slots[idx];
+			slots[idx] = sample;
+			idx = idx + 1 == N ? 0 : idx + 1;
+			return value();
+		}
+
+		T value() const
+		{
+			return FilterMath::Divide<N>::apply(sum);
+		}
+
+	private:
+		T slots[N];
+		uint32_t sum;
+		uint8_t idx;
+};
+
+template<typename T, size_t N>
+class Ema
+{
+	public:
+		static_assert(N && !(N & (N - 1)), "Ema weight must be 1 / power of 2");
+		static_assert(sizeof(T) <= 2 && (T) -1 > 0,
+				"Ema filters unsigned 8 or 16-bit samples");
+
+		Ema() :
+				acc(0)
+		{
+		}
+
+		void fill(T value)
+		{
+			acc = (uint32_t) value * N;
+		}
+
+		// acc holds N x the average, so the new sample counts 1/N
+		T add(T sample)
+		{
+			acc -= FilterMath::Divide<N>::apply(acc);
+			acc += sample;
+			return value();
+		}
+
+		T value() const
+		{
+			return FilterMath::Divide<N>::apply(acc + N / 2);
+		}
+
+	private:
+		uint32_t acc;
+};
+
+template<typename T, size_t N>
+class Median
+{
+	public:
+		static_assert(N > 0 && N < 256, "Median length must be 1 - 255");
+
+		Median() :
+				idx(0)
+		{
+			fill(0);
+		}
+
+		void fill(T value)
+		{
+			for (uint8_t cnt = 0; cnt < N; cnt++)
+			{
+				slots[cnt] = sorted[cnt] = value;
+			}
+			idx = 0;
+		}
+
+		T add(T sample)
+		{
+			// Find the oldest sample in the sorted copy
+			T oldest = slots[idx];
+			slots[idx] = sample;
+			idx = idx + 1 == N ? 0 : idx + 1;
+
+			uint8_t lo = 0, hi = N - 1;
+			while (lo < hi)
+			{
+				uint8_t mid = (lo + hi) / 2;
+				if (sorted[mid] < oldest) lo = mid + 1;
+				else hi = mid;
+			}
+
+			// ... and slide the new one into its place
+			uint8_t pos = lo;
+			while (pos > 0 && sorted[pos - 1] > sample)
+			{
+				sorted[pos] = sorted[pos - 1];
+				pos--;
+			}
+			while (pos < N - 1 && sorted[pos + 1] < sample)
+			{
+				sorted[pos] = sorted[pos + 1];
+				pos++;
+			}
+			sorted[pos] = sample;
+			return value();
+		}
+
+		T value() const
+		{
+			return sorted[N / 2];
+		}
+
+	private:
+		T slots[N];
+		T sorted[N];
+		uint8_t idx;
+};
+
+#endif /* _FILTERS_H_ */
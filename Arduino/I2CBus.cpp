@@ -0,0 +1,132 @@
+#include "I2CBus.h"
+#include <EEPROM.h>
+
+// Clocks tune() tries, in kHz
+static const uint16_t tuneSteps[] = { 100, 200, 400, 800, 1000 };
+
+I2CBusClient::I2CBusClient(I2CBus &bus, uint8_t priority, uint32_t clock) :
+		clock(clock), transfers(0), requests(0), waitMicros(0),
+		maxWaitMicros(0), preemptions(0), bus(bus), priority(priority),
+		requested(false), dueMicros(0), next(NULL)
+{
+	bus.add(this);
+}
+
+void I2CBusClient::request(unsigned long dueMicros)
+{
+	this->dueMicros = dueMicros;
+	requested = true;
+}
+
+void I2CBusClient::acquire()
+{
+#ifdef SSD1306_TWI_STREAM
+	bus.wire.pause();
+#endif
+	bus.setClock(clock);
+	transfers++;
+
+	// A request taken up early has not waited at all
+	if (requested)
+	{
+		long wait = (long) (micros() - dueMicros);
+		if (wait < 0) wait = 0;
+		requests++;
+		waitMicros += wait;
+		if (wait > maxWaitMicros) maxWaitMicros = wait > 0xFFFF ? 0xFFFF : wait;
+		requested = false;
+	}
+}
+
+// Transfers never overlap in the sketch, so there is nothing to hand on
+void I2CBusClient::release()
+{
+}
+
+boolean I2CBusClient::preempted()
+{
+	if (!bus.contended(*this)) return false;
+	preemptions++;
+	return true;
+}
+
+uint32_t I2CBusClient::tune(bool (*check)(), int eeprom, uint32_t maxClock)
+{
+	uint16_t kHz;
+	if (EEPROM.read(eeprom) == I2C_CLOCK_SAVED)
+	{
+		EEPROM.get(eeprom + 1, kHz);
+		if (kHz && kHz * 1000UL <= maxClock && passes(check, kHz * 1000UL))
+		{
+			return clock;
+		}
+	}
+
+	// Step up until a check fails; 100 kHz whatever happens, as the
+	// device may just not be there
+	uint32_t best = tuneSteps[0] * 1000UL;
+	for (uint8_t i = 0; i < sizeof(tuneSteps) / sizeof(tuneSteps[0]); i++)
+	{
+		uint32_t step = tuneSteps[i] * 1000UL;
+		if (step > maxClock || !passes(check, step)) break;
+		best = step;
+	}
+
+	clock = best;
+	kHz = best / 1000;
+	EEPROM.update(eeprom, I2C_CLOCK_SAVED);
+	EEPROM.put(eeprom + 1, kHz);
+	return clock;
+}
+
+// Does 'check' pass every time at 'clock'? Leaves the clock set to it.
+bool I2CBusClient::passes(bool (*check)(), uint32_t clock)
+{
+	this->clock = clock;
+	for (uint8_t i = 0; i < I2C_TUNE_CHECKS; i++)
+	{
+		if (!check()) return false;
+	}
+	return true;
+}
+
+I2CBus::I2CBus(TwoWire &wire) :
+		wire(wire), clients(NULL), clock(0)
+{
+}
+
+void I2CBus::begin()
+{
+	wire.begin();
+	clock = 0;
+}
+
+bool I2CBus::contended(const I2CBusClient &client)
+{
+	unsigned long now = micros();
+	for (I2CBusClient *other = clients;
+			other && other->priority < client.priority; other = other->next)
+	{
+		if (other->requested && (long) (now - other->dueMicros) >= 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// Keep the clients in order of priority, first come first within one
+void I2CBus::add(I2CBusClient *client)
+{
+	I2CBusClient **at = &clients;
+	while (*at && (*at)->priority <= client->priority) at = &(*at)->next;
+	client->next = *at;
+	*at = client;
+}
+
+void I2CBus::setClock(uint32_t clock)
+{
+	if (clock == this->clock) return;
+	wire.setClock(clock);
+	this->clock = clock;
+}
@@ -0,0 +1,100 @@
+// Arbiter for the I2C bus the INA219 and the SSD1306 share
+//
+// Each device has a client on the bus with a priority (lower is more
+// urgent) and its own clock, which is only set when the bus passes to a
+// device wanting a different one. A client says when it will next want
+// the bus with request() (the INA219 when its conversion should be
+// ready), then takes it with acquire() and gives it back with release()
+// around each transfer. The clients waiting form the queue: a long
+// transfer made in chunks (the display's flush) checks preempted() between
+// chunks and stops as soon as a more urgent client's request is due, so
+// the sketch can serve that first.
+//
+// Each client keeps count of its transfers and of how long its requests
+// waited between falling due and getting the bus.
+//
+// tune() finds the fastest clock a device keeps up with, stepping up from
+// 100 kHz until a check of the device (a register read back, an
+// acknowledged command) fails, and keeps it in EEPROM so the next start
+// only has to check it again.
+//
+// With SSD1306_TWI_ISR (see Adafruit_SSD1306.h) the display's windows go
+// out from the TWI interrupt while the sketch runs on; a client taking
+// the bus meanwhile stops the transfer at the end of the page being sent.
+// Wire is not used then, and must not be included.
+
+#ifndef _I2CBUS_H_
+#define _I2CBUS_H_
+#include "Arduino.h"
+#include <Adafruit_SSD1306.h> // Includes Wire, or what stands in for it
+
+#define I2C_PRIORITY_SENSOR 0
+#define I2C_PRIORITY_DISPLAY 1
+
+#define I2C_CLOCK_SAVED 0xC5 // Marks a clock kept in EEPROM by tune()
+#define I2C_TUNE_CHECKS 16   // Checks a clock must pass to be used
+
+class I2CBus;
+
+class I2CBusClient : public SSD1306_BusArbiter
+{
+	public:
+		I2CBusClient(I2CBus &bus, uint8_t priority, uint32_t clock);
+
+		// The bus will be wanted from 'dueMicros' on
+		void request(unsigned long dueMicros);
+
+		void acquire();
+		void release();
+
+		// Is a more urgent client's request due?
+		boolean preempted();
+
+		// Set the clock to the fastest, up to 'maxClock', at which 'check'
+		// passes; the one kept at 'eeprom' (3 bytes) if it still does, else
+		// found again and kept there. Returns the clock.
+		uint32_t tune(bool (*check)(), int eeprom, uint32_t maxClock = 1000000UL);
+
+		uint32_t clock;       // Hz
+
+		uint32_t transfers;   // Bus acquisitions
+		uint32_t requests;    // Requests served
+		uint32_t waitMicros;  // Total wait of those requests, wrapping
+		uint16_t maxWaitMicros;
+		uint16_t preemptions; // Times preempted() said yes, wrapping
+
+	private:
+		friend class I2CBus;
+
+		I2CBus &bus;
+		uint8_t priority;
+		bool requested;
+		unsigned long dueMicros;
+		I2CBusClient *next;
+
+		bool passes(bool (*check)(), uint32_t clock);
+};
+
+class I2CBus
+{
+	public:
+		I2CBus(TwoWire &wire);
+
+		// Start the bus; the clock is then unknown until a client sets it
+		void begin();
+
+		// Does any client more urgent than 'client' have a request due?
+		bool contended(const I2CBusClient &client);
+
+	private:
+		friend class I2CBusClient;
+
+		void add(I2CBusClient *client);
+		void setClock(uint32_t clock);
+
+		TwoWire &wire;
+		I2CBusClient *clients; // Most urgent first
+		uint32_t clock;        // As last set, 0 if unknown
+};
+
+#endif /* _I2CBUS_H_ */
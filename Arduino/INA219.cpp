@@ -0,0 +1,119 @@
+#include "INA219.h"
+#include "I2CBus.h"
+
+INA219::INA219(uint8_t address) :
+		current(0), bus(0), power(0), sampledAt(0), resets(0),
+		busClient(NULL), address(address), calibration(0), config(0),
+		triggeredAt(0), pending(false)
+{
+}
+
+bool INA219::writeRegister(uint8_t reg, uint16_t value)
+{
+	if (busClient) busClient->acquire();
+	Wire.beginTransmission(address);
+	Wire.write(reg);
+	Wire.write((value >> 8) & 0xFF);
+	Wire.write(value & 0xFF);
+	bool acked = Wire.endTransmission() == 0;
+	if (busClient) busClient->release();
+	return acked;
+}
+
+bool INA219::readRegister(uint8_t reg, uint16_t &value)
+{
+	if (busClient) busClient->acquire();
+
+	// Set the register pointer, then read the two bytes it points at
+	Wire.beginTransmission(address);
+	Wire.write(reg);
+	bool read = Wire.endTransmission() == 0
+			&& Wire.requestFrom(address, (uint8_t) 2) == 2;
+	if (read)
+	{
+		value = Wire.read() << 8;
+		value |= Wire.read();
+	}
+
+	if (busClient) busClient->release();
+	return read;
+}
+
+bool INA219::begin(uint16_t calibration, uint16_t config)
+{
+	this->calibration = calibration;
+	this->config = config;
+	pending = false;
+	return writeRegister(INA219_REG_CALIBRATION, calibration)
+			&& writeRegister(INA219_REG_CONFIG, config);
+}
+
+void INA219::configure(uint16_t config)
+{
+	this->config = config;
+	pending = false;
+	writeRegister(INA219_REG_CONFIG, config);
+}
+
+// Put back what a reset of the chip has undone
+void INA219::recover()
+{
+	resets++;
+	writeRegister(INA219_REG_CALIBRATION, calibration);
+	writeRegister(INA219_REG_CONFIG, config);
+}
+
+void INA219::startConversion()
+{
+	uint8_t mode = config & INA219_CONFIG_MODE_MASK;
+	if (mode > 0 && mode < 4)
+	{
+		// Writing the mode starts a conversion and clears CNVR
+		writeRegister(INA219_REG_CONFIG, config);
+	}
+	triggeredAt = micros();
+	pending = true;
+}
+
+bool INA219::poll()
+{
+	if (!pending) return false;
+
+	uint16_t value;
+	if (!readRegister(INA219_REG_BUSVOLTAGE, value)) return false;
+	if (!(value & INA219_BUS_CNVR)) return false;
+	bus = value >> 3;
+	uint8_t mode = config & INA219_CONFIG_MODE_MASK;
+	sampledAt = (mode > 0 && mode < 4) ? triggeredAt : micros();
+
+	if (!readRegister(INA219_REG_CURRENT, value)) return false;
+	current = value;
+
+	// Reading power clears CNVR, ready for the next conversion
+	if (!readRegister(INA219_REG_POWER, power)) return false;
+	pending = false;
+
+	// A reset chip has no calibration, so reads zero current
+	if (current == 0 && readRegister(INA219_REG_CALIBRATION, value)
+			&& value != (calibration & 0xFFFE))
+	{
+		recover();
+	}
+	return true;
+}
+
+bool INA219::verify()
+{
+	uint16_t value;
+	return readRegister(INA219_REG_CALIBRATION, value)
+			&& value == (calibration & 0xFFFE)
+			&& readRegister(INA219_REG_CONFIG, value) && value == config;
+}
+
+bool INA219::readCurrent()
+{
+	uint16_t value;
+	if (!readRegister(INA219_REG_CURRENT, value)) return false;
+	current = value;
+	return true;
+}
@@ -0,0 +1,225 @@
+// INA219 current monitor on the I2C bus
+//
+// Nothing here waits for the chip: startConversion() asks for a reading
+// and poll() returns true once the conversion ready (CNVR) flag in the bus
+// voltage register says it is there, so the caller can get on with other
+// work in between. In a continuous mode poll() just picks up each new
+// conversion in turn. Each reading carries the time it was taken, so that
+// however late poll() picks it up, the intervals between readings are the
+// chip's own.
+//
+// The calibration is written once by begin(). The chip loses it if it is
+// reset (e.g. by a sharp change in load), after which the current reads
+// zero; only then is the calibration register read back, and calibration
+// and configuration are rewritten if it no longer holds ours.
+//
+// With setBus() every transfer goes through the shared bus arbiter (see
+// I2CBus.h), which sets the clock for it.
+//
+// INA219Calibration works out the calibration and configuration for a
+// given shunt, current range, gain and averaging at compile time, along
+// with the factors that turn the current and power registers into mA and
+// mW with one multiply and shift.
+
+#ifndef _INA219_H_
+#define _INA219_H_
+#include "Arduino.h"
+
+// INA219 Registers
+#define INA219_REG_CONFIG (0x0)
+#define INA219_REG_SHUNTVOLTAGE (0x1)
+#define INA219_REG_BUSVOLTAGE (0x2)
+#define INA219_REG_POWER (0x3)
+#define INA219_REG_CURRENT (0x04)
+#define INA219_REG_CALIBRATION (0x5)
+
+// INA219 Config values used to measure current in mA
+#define INA219_CONFIG_RESET 					(0x8000)// Power-on reset
+#define INA219_CONFIG_BVOLTAGERANGE_16V 		(0x0000)// 0-16V Range
+#define INA219_CONFIG_BVOLTAGERANGE_32V 		(0x2000)// 0-32V Range
+#define INA219_CONFIG_GAIN_8_320MV 				6144	// 8 x Gain
+#define INA219_CONFIG_BADCRES_12BIT 			384 	// Bus ADC resolution bits
+#define INA219_CONFIG_SADCRES_12BIT_1S_532US 	24 		// 1 x 12=bit sample
+#define INA219_CONFIG_MODE_SANDBVOLT_TRIGGERED 	3		// One conversion per config write
+#define INA219_CONFIG_MODE_SANDBVOLT_CONTINUOUS 7		// Continuous conversion (not triggered)
+#define INA219_CONFIG_MODE_MASK 				7
+#define INA219_CONFIG_SADCRES_12BIT_8S_4260US 	(0x0058)// 8 x 12-bit shunt samples averaged together
+
+// Bus voltage register flags
+#define INA219_BUS_CNVR 0x02 // Conversion ready, cleared by reading power
+#define INA219_BUS_OVF 0x01  // Power or current out of range
+
+class I2CBusClient;
+
+class INA219
+{
+	public:
+		INA219(uint8_t address = 0x40);
+
+		// Write calibration and configuration; returns false if nothing
+		// acknowledged them
+		bool begin(uint16_t calibration, uint16_t config);
+
+		// Change the configuration (e.g. mode or averaging), dropping any
+		// reading asked for under the old one
+		void configure(uint16_t config);
+
+		// Ask for a new reading: triggers a conversion in a triggered mode
+		void startConversion();
+
+		// Returns true, once, when the reading asked for is ready. It was
+		// taken when startConversion() triggered it, in a triggered mode,
+		// or when poll() first found it ready in a continuous one.
+		bool poll();
+
+		// Read just the current register: in a continuous mode, the latest
+		// conversion whether or not it has been read before
+		bool readCurrent();
+
+		// Read back calibration and configuration: true if both still hold
+		// what begin() wrote, e.g. to check the bus clock suits the chip
+		bool verify();
+
+		bool converting()
+		{
+			return pending;
+		}
+
+		// Go through 'client' on a shared bus
+		void setBus(I2CBusClient *client)
+		{
+			busClient = client;
+		}
+
+		// The last reading, as register values
+		int16_t current;  // LSB set by the calibration
+		uint16_t bus;     // Bus voltage, 4mV LSB
+		uint16_t power;   // 20 x the current LSB, in mW per mA
+		unsigned long sampledAt; // micros() it was taken, see poll()
+
+		uint16_t resets;  // Times the calibration was found lost and rewritten
+
+	private:
+		bool writeRegister(uint8_t reg, uint16_t value);
+		bool readRegister(uint8_t reg, uint16_t &value);
+		void recover();
+
+		I2CBusClient *busClient;
+		uint8_t address;
+		uint16_t calibration;
+		uint16_t config;
+		unsigned long triggeredAt;
+		bool pending;
+};
+
+namespace INA219Math
+{
+	constexpr uint8_t log2(uint16_t n)
+	{
+		return n > 1 ? 1 + log2(n / 2) : 0;
+	}
+
+	// The first of 1, 2, 5, 10, 20, 50, ... at or above n
+	constexpr uint32_t roundUp(uint32_t n, uint32_t step = 1)
+	{
+		return n <= step ? step : n <= 2 * step ? 2 * step :
+				n <= 5 * step ? 5 * step : roundUp(n, step * 10);
+	}
+
+	// The largest shift, up to 16, for which x * (num << shift) / den
+	// stays within 32 bits for every x up to maxIn
+	constexpr uint8_t scaleShift(uint32_t num, uint32_t den, uint32_t maxIn,
+			uint8_t shift = 16)
+	{
+		return shift == 0
+				|| (uint64_t) maxIn * ((((uint64_t) num << shift) + den / 2) / den)
+						<= 0xFFFFFFFFULL ? shift :
+				scaleShift(num, den, maxIn, shift - 1);
+	}
+
+	constexpr uint64_t difference(uint64_t a, uint64_t b)
+	{
+		return a > b ? a - b : b - a;
+	}
+}
+
+// x * Num / Den, rounded down, for x up to MaxIn
+template<uint32_t Num, uint32_t Den, uint32_t MaxIn>
+struct INA219Scale
+{
+	static const uint8_t shift = INA219Math::scaleShift(Num, Den, MaxIn);
+	static const uint32_t multiplier =
+			(((uint64_t) Num << shift) + Den / 2) / Den;
+
+	static_assert(multiplier > 0, "Scale too small for a 16-bit shift");
+	static_assert((uint64_t) MaxIn
+			* INA219Math::difference((uint64_t) multiplier * Den,
+					(uint64_t) Num << shift) < ((uint64_t) Den << shift),
+			"Rounded multiplier is out by a unit or more at MaxIn");
+
+	static uint32_t apply(uint32_t x)
+	{
+		return (x * multiplier) >> shift;
+	}
+};
+
+// Calibration for a shunt of ShuntMilliOhms measuring up to MaxMilliAmps,
+// PGA Gain 1, 2, 4 or 8 (40mV - 320mV) and Samples 12-bit shunt
+// conversions averaged. The bus range is 32V.
+template<uint16_t ShuntMilliOhms, uint16_t MaxMilliAmps, uint8_t Gain,
+		uint8_t Samples>
+struct INA219Calibration
+{
+	static_assert(Gain == 1 || Gain == 2 || Gain == 4 || Gain == 8,
+			"PGA gain is 1, 2, 4 or 8");
+	static_assert(Samples && Samples <= 128 && !(Samples & (Samples - 1)),
+			"Samples averaged is 1 - 128, a power of 2");
+
+	// mA x milliohms is uV: the shunt voltage must stay within the PGA range
+	static_assert((uint32_t) MaxMilliAmps * ShuntMilliOhms <= 40000UL * Gain,
+			"MaxMilliAmps overflows the shunt ADC at this gain");
+
+	// Current LSB in uA: MaxMilliAmps over the 15 bits of the current
+	// register, rounded up to a round number as the datasheet suggests
+	static const uint32_t currentLSB = INA219Math::roundUp(
+			((uint32_t) MaxMilliAmps * 1000 + 32767) / 32768);
+
+	// uA x milliohms is nV; the shunt ADC LSB is 10uV
+	static_assert(currentLSB * ShuntMilliOhms <= 10000,
+			"Current LSB coarser than the shunt ADC: resolution lost");
+
+	// Calibration = 0.04096 / (current LSB x shunt), bit 0 unused
+	static const uint32_t exactCalibration = 40960000UL
+			/ (currentLSB * ShuntMilliOhms);
+	static_assert(exactCalibration <= 0xFFFF,
+			"Calibration overflows its register");
+	static const uint16_t calibration = exactCalibration & 0xFFFE;
+	static_assert(40960000UL - (uint32_t) calibration * currentLSB
+			* ShuntMilliOhms <= 40960000UL / 1000,
+			"Calibration truncated by more than 0.1%: resolution lost");
+
+	static const uint16_t config = INA219_CONFIG_BVOLTAGERANGE_32V
+			| (INA219Math::log2(Gain) << 11)
+			| INA219_CONFIG_BADCRES_12BIT
+			| ((Samples == 1 ? 0x3 : 0x8 | INA219Math::log2(Samples)) << 3);
+
+	// A little over the datasheet's conversion time
+	static const uint32_t conversionMicros = Samples * 532UL + Samples / 2;
+
+	// Current register (up to 15 bits) to mA, power register (20 x the
+	// current LSB) to mW
+	typedef INA219Scale<currentLSB, 1000, 32767> Current;
+	typedef INA219Scale<20 * currentLSB, 1000, 65535> Power;
+
+	static uint16_t milliAmps(int16_t current)
+	{
+		return current < 0 ? 0 : Current::apply(current);
+	}
+
+	static uint32_t milliWatts(uint16_t power)
+	{
+		return Power::apply(power);
+	}
+};
+
+#endif /* _INA219_H_ */
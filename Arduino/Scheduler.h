@@ -0,0 +1,88 @@
+// Tiny cooperative scheduler based on millis()
+//
+// Each task is a function that does a short piece of work and returns; it
+// is run again once its interval has passed. Nothing ever blocks: waiting
+// is done by asking to be run later (runIn) instead of calling delay(), or
+// for waits under a millisecond by running on every pass (interval 0) and
+// returning until the time has come.
+
+#ifndef _SCHEDULER_H_
+#define _SCHEDULER_H_
+#include "Arduino.h"
+
+class Scheduler
+{
+	public:
+		typedef void (*TaskFunction)();
+
+		struct Task
+		{
+			TaskFunction run;
+			unsigned long interval; // mS between runs, 0 = every pass
+			unsigned long nextRun;  // millis() at which the task is due
+			bool enabled;
+		};
+
+		Scheduler(Task *tasks, uint8_t count) :
+				tasks(tasks), count(count)
+		{
+		}
+
+		// Call from loop(): runs every task that is due, then idles until
+		// the next one is
+		void run()
+		{
+			for (uint8_t id = 0; id < count; id++)
+			{
+				Task &task = tasks[id];
+				unsigned long now = millis();
+				if (task.enabled && (long) (now - task.nextRun) >= 0)
+				{
+					// Set before running so the task can reschedule itself
+					task.nextRun = now + task.interval;
+					task.run();
+				}
+			}
+
+			// Nothing can run before the earliest due task, and serial
+			// input is buffered by interrupts meanwhile
+			unsigned long now = millis();
+			long idle = -1;
+			for (uint8_t id = 0; id < count; id++)
+			{
+				if (!tasks[id].enabled) continue;
+				long wait = (long) (tasks[id].nextRun - now);
+				if (wait <= 0)
+				{
+					yield(); // Polling: let the core have its turn
+					return;
+				}
+				if (idle < 0 || wait < idle) idle = wait;
+			}
+			if (idle > 0) delay(idle);
+		}
+
+		// Run the task 'ms' from now, whatever its interval
+		void runIn(uint8_t id, unsigned long ms)
+		{
+			tasks[id].nextRun = millis() + ms;
+		}
+
+		// Switch a task on (due straight away) or off
+		void enable(uint8_t id, bool on = true)
+		{
+			if (on && !tasks[id].enabled) tasks[id].nextRun = millis();
+			tasks[id].enabled = on;
+		}
+
+		bool isEnabled(uint8_t id)
+		{
+			return tasks[id].enabled;
+		}
+
+	private:
+		Task *tasks;
+		uint8_t count;
+};
+
+#endif /* _SCHEDULER_H_ */
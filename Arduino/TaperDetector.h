@@ -0,0 +1,79 @@
+// Battery level from the charge current alone, for when the phone is silent
+//
+// A Li-ion charger holds a constant current until the cell reaches its
+// full voltage, at about 80%, then holds that voltage while the current
+// tapers off towards zero at 100%. The highest (filtered) current seen
+// since charging started is taken as the constant-current plateau; once
+// the current has stayed clearly below it for a while the taper has
+// begun, and the level is read off how far it has fallen, taking the
+// taper as linear.
+//
+// Anything else that lowers the current looks the same (the phone turning
+// its screen off), so this is only a fallback for when the phone says
+// nothing at all.
+
+#ifndef _TAPERDETECTOR_H_
+#define _TAPERDETECTOR_H_
+#include "Arduino.h"
+
+class TaperDetector
+{
+	public:
+		TaperDetector()
+		{
+			reset();
+		}
+
+		// Charging (re)starts
+		void reset()
+		{
+			plateau = 0;
+			below = 0;
+			tapering = false;
+		}
+
+		// A filtered current sample while charging
+		void add(uint16_t milliAmps)
+		{
+			if (milliAmps > plateau)
+			{
+				plateau = milliAmps;
+				below = 0;
+				tapering = false;
+				return;
+			}
+
+			// Below 15/16 of the plateau counts as tapering
+			if ((uint32_t) milliAmps * 16 < (uint32_t) plateau * 15)
+			{
+				if (below < confirmSamples) below++;
+				else tapering = true;
+			} else if (!tapering)
+			{
+				below = 0;
+			}
+		}
+
+		bool isTapering() const
+		{
+			return tapering;
+		}
+
+		// Estimated level %, 0 until the taper has been seen
+		uint8_t level(uint16_t milliAmps) const
+		{
+			if (!tapering) return 0;
+			if (milliAmps >= plateau) return cvLevel;
+			return 100 - (uint32_t) (100 - cvLevel) * milliAmps / plateau;
+		}
+
+	private:
+		static const uint8_t cvLevel = 80;         // % where the taper starts
+		static const uint8_t confirmSamples = 20;  // In a row below the plateau
+
+		uint16_t plateau; // Highest current since charging started
+		uint8_t below;    // Samples in a row below it
+		bool tapering;
+};
+
+#endif /* _TAPERDETECTOR_H_ */
@@ -0,0 +1,145 @@
+#include "TransientCapture.h"
+
+TransientCapture::TransientCapture(uint8_t deadband) :
+		captures(0), head(0), count(0), startAt(0), runAt(0), inRun(false),
+		last(0), event(CAPTURE_OFF), started(false), recording(false),
+		full(false), deadband(deadband)
+{
+}
+
+void TransientCapture::start(uint8_t event)
+{
+	this->event = event;
+	started = false;
+	inRun = false;
+	full = false;
+	recording = true;
+	captures++;
+}
+
+bool TransientCapture::add(uint16_t milliAmps, uint8_t missed)
+{
+	if (!recording || full) return false;
+
+	if (!started)
+	{
+		// Older captures may go to make room for this one's start
+		recording = false;
+		append(0xE0 | event, milliAmps >> 8, milliAmps & 0xFF, 3);
+		startAt = head + count - 3;
+		recording = true;
+		started = true;
+		last = milliAmps;
+		return true;
+	}
+
+	// Conversions missed while the current held steady count as samples
+	// of it; otherwise only how many there were is known
+	int16_t change = milliAmps - last;
+	if (change >= -deadband && change <= deadband)
+	{
+		return lengthenRun(missed + 1);
+	}
+	if (missed)
+	{
+		if (!append(0xC1, missed, 0, 2)) return false;
+		inRun = false;
+	}
+
+	if (change >= -64 && change <= 63)
+	{
+		if (!append(change & 0x7F)) return false;
+	} else if (!append(0xC0, milliAmps >> 8, milliAmps & 0xFF, 3))
+	{
+		return false;
+	}
+	inRun = false;
+	last = milliAmps;
+	return true;
+}
+
+// Add 'samples' to the run the capture ends with, or start one
+bool TransientCapture::lengthenRun(uint16_t samples)
+{
+	while (samples)
+	{
+		if (!inRun || (ring[runAt] & 0x3F) == 0x3F)
+		{
+			if (!append(0x80)) return false;
+			runAt = head + count - 1;
+			inRun = true;
+			samples--;
+			continue;
+		}
+
+		uint8_t room = 0x3F - (ring[runAt] & 0x3F);
+		uint8_t more = samples < room ? samples : room;
+		ring[runAt] += more;
+		samples -= more;
+	}
+	return true;
+}
+
+uint16_t TransientCapture::read(uint16_t pos, Record &record)
+{
+	uint8_t first = at(pos);
+	if (first < 0x80)
+	{
+		record.kind = CAPTURE_SAMPLES;
+		record.count = 1;
+		record.milliAmps += (int8_t) (first << 1) >> 1;
+	} else if (first < 0xC0)
+	{
+		record.kind = CAPTURE_SAMPLES;
+		record.count = (first & 0x3F) + 1;
+	} else if (first == 0xC1)
+	{
+		record.kind = CAPTURE_GAP;
+		record.count = at(pos + 1);
+	} else
+	{
+		record.kind = first == 0xC0 ? CAPTURE_SAMPLES : CAPTURE_START;
+		record.event = first & 1;
+		record.count = 1;
+		record.milliAmps = at(pos + 1) << 8 | at(pos + 2);
+	}
+	return pos + recordLength(first);
+}
+
+uint8_t TransientCapture::recordLength(uint8_t first)
+{
+	if (first < 0xC0) return 1;
+	return first == 0xC1 ? 2 : 3;
+}
+
+// Write one record of 'n' bytes, making room for it if need be
+bool TransientCapture::append(uint8_t b0, uint8_t b1, uint8_t b2, uint8_t n)
+{
+	while (size - count < n)
+	{
+		if (recording && head == startAt)
+		{
+			full = true;
+			return false;
+		}
+		dropOldest();
+	}
+
+	uint8_t bytes[3] = { b0, b1, b2 };
+	for (uint8_t idx = 0; idx < n; idx++)
+	{
+		ring[(uint8_t) (head + count++)] = bytes[idx];
+	}
+	return true;
+}
+
+// Drop the oldest capture whole
+void TransientCapture::dropOldest()
+{
+	do
+	{
+		uint8_t length = recordLength(ring[head]);
+		head += length;
+		count -= length;
+	} while (count && ring[head] < 0xE0);
+}
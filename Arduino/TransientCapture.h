@@ -0,0 +1,109 @@
+// Current transients after a switch, at the INA219's full rate
+//
+// The averaged readings the charger runs on smear out what happens in the
+// first moments after the MOSFET switches. A capture records every 532uS
+// single-sample conversion for a while after a switch instead, in a ring
+// of mostly one-byte records:
+//
+//   0x00 - 0x7F  next sample: change from the last, -64 to +63 mA
+//   0x80 - 0xBF  next 1 - 64 samples: no change (within the deadband)
+//   0xC0 hi lo   next sample, in full
+//   0xC1 n       n conversions missed before the next sample
+//   0xE0 hi lo   capture after a switch off: its first sample, in full
+//   0xE1 hi lo   ... after a switch on
+//
+// Changes within the deadband count as none, so a steady but noisy current
+// costs a byte per 64 samples, conversions the sketch was too busy to read
+// included. A new capture makes room by dropping whole
+// captures, oldest first; one that would have to drop itself is full and
+// records no more.
+
+#ifndef _TRANSIENTCAPTURE_H_
+#define _TRANSIENTCAPTURE_H_
+#include "Arduino.h"
+
+#define CAPTURE_OFF 0
+#define CAPTURE_ON 1
+
+// Records as read back
+#define CAPTURE_START 0   // A capture begins: event, first sample
+#define CAPTURE_SAMPLES 1 // 'count' samples of milliAmps
+#define CAPTURE_GAP 2     // 'count' conversions missed
+
+class TransientCapture
+{
+	public:
+		static const uint16_t size = 256;
+
+		struct Record
+		{
+			uint8_t kind;
+			uint8_t event;      // CAPTURE_OFF or CAPTURE_ON, of a start
+			uint8_t count;
+			uint16_t milliAmps; // Carried on from the record before
+		};
+
+		TransientCapture(uint8_t deadband);
+
+		// A new capture after 'event'; its first sample starts it
+		void start(uint8_t event);
+
+		// Record the next sample, 'missed' conversions after the last;
+		// returns false once the capture is full
+		bool add(uint16_t milliAmps, uint8_t missed = 0);
+
+		void stop()
+		{
+			recording = false;
+		}
+
+		bool isRecording()
+		{
+			return recording;
+		}
+
+		bool isFull()
+		{
+			return full;
+		}
+
+		// Bytes held, oldest capture first
+		uint16_t length()
+		{
+			return count;
+		}
+
+		uint8_t at(uint16_t idx)
+		{
+			return ring[(uint8_t) (head + idx)];
+		}
+
+		// Decode the record at 'pos' into 'record' and return the position
+		// of the next; start at 0 and stop at length()
+		uint16_t read(uint16_t pos, Record &record);
+
+		uint8_t captures; // Started so far, wrapping
+
+	private:
+		bool append(uint8_t b0, uint8_t b1 = 0, uint8_t b2 = 0,
+				uint8_t n = 1);
+		bool lengthenRun(uint16_t samples);
+		uint8_t recordLength(uint8_t first);
+		void dropOldest();
+
+		uint8_t ring[size];
+		uint8_t head;
+		uint16_t count;
+
+		uint8_t startAt;  // Start record of the capture being made
+		uint8_t runAt;    // Its last record, if that is a run
+		bool inRun;
+		uint16_t last;    // Its last sample, as recorded
+		uint8_t event;
+		bool started;     // Its start record is in
+		bool recording;
+		bool full;
+		uint8_t deadband;
+};
+
+#endif /* _TRANSIENTCAPTURE_H_ */
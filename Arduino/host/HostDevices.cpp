@@ -0,0 +1,180 @@
+// I2C device models for the host build.
+
+#include "HostDevices.h"
+#include "Wire.h"
+
+#include <string.h>
+
+namespace host {
+
+// SSD1306 PANEL -----------------------------------------------------------
+
+SSD1306Panel::SSD1306Panel(uint8_t w, uint8_t h) : dataBytes(0),
+  commandBytes(0), maxClock(0), width(w), pages((h + 7) / 8), colStart(0), colEnd(w - 1),
+  pageStart(0), pageEnd(pages - 1), col(0), page(0), pendingLen(0),
+  pendingNeed(0) {
+  memset(gddram, 0, sizeof(gddram));
+}
+
+// Number of argument bytes following each multi-byte command
+static uint8_t commandArgs(uint8_t c) {
+  switch(c) {
+   case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5:
+   case 0xD9: case 0xDA: case 0xDB:
+    return 1;
+   case 0x21: case 0x22: case 0xA3:
+    return 2;
+   case 0x29: case 0x2A:
+    return 5;
+   case 0x26: case 0x27:
+    return 6;
+  }
+  return 0;
+}
+
+void SSD1306Panel::command(uint8_t c) {
+  commandBytes++;
+  if(pendingNeed) { // Argument of a multi-byte command
+    pending[pendingLen++] = c;
+  } else {
+    pending[0]  = c;
+    pendingLen  = 1;
+    pendingNeed = commandArgs(c) + 1;
+  }
+  if(pendingLen < pendingNeed) return;
+  pendingNeed = 0;
+
+  switch(pending[0]) {
+   case 0x21: // COLUMNADDR
+    colStart = pending[1] % width;
+    colEnd   = pending[2] % width;
+    col      = colStart;
+    break;
+   case 0x22: // PAGEADDR
+    pageStart = pending[1] % pages;
+    pageEnd   = pending[2] % pages;
+    page      = pageStart;
+    break;
+  }
+}
+
+bool SSD1306Panel::write(const uint8_t *data, size_t len) {
+  if(maxClock && (Wire.getClock() > maxClock)) return false; // No ACK
+  if(!len) return true;
+  bool isData = data[0] & 0x40;
+  while(--len) {
+    uint8_t b = *++data;
+    if(!isData) {
+      command(b);
+      continue;
+    }
+    dataBytes++;
+    gddram[page * width + col] = b;
+    if(col++ >= colEnd) {
+      col = colStart;
+      if(page++ >= pageEnd) page = pageStart;
+    }
+  }
+  return true;
+}
+
+size_t SSD1306Panel::read(uint8_t *data, size_t len) {
+  (void)data; (void)len;
+  return 0; // Write-only over I2C
+}
+
+// INA219 ------------------------------------------------------------------
+
+enum {
+  REG_CONFIG, REG_SHUNT, REG_BUS, REG_POWER, REG_CURRENT, REG_CALIBRATION
+};
+
+INA219Model::INA219Model() : maxClock(0), pointer(0), loadMilliAmps(0),
+  loadMilliVolts(5000) {
+  powerOnReset();
+}
+
+void INA219Model::powerOnReset(void) {
+  memset(regs, 0, sizeof(regs));
+  regs[REG_CONFIG]  = 0x399F;
+  conversionStart   = nowMicros();
+  conversionCleared = false;
+  update();
+}
+
+void INA219Model::setLoad(int32_t milliAmps, uint32_t busMilliVolts) {
+  loadMilliAmps  = milliAmps;
+  loadMilliVolts = busMilliVolts;
+  update();
+}
+
+// Shunt ADC conversion time for the SADC field (config bits 6..3)
+uint32_t INA219Model::conversionMicros(void) const {
+  static const uint32_t averaged[] = {
+    532, 1060, 2130, 4260, 8510, 17020, 34050, 68100 };
+  static const uint32_t single[] = { 84, 148, 276, 532 };
+  uint8_t sadc = (regs[REG_CONFIG] >> 3) & 0x0F;
+  return (sadc & 0x08) ? averaged[sadc & 7] : single[sadc & 3];
+}
+
+void INA219Model::update(void) {
+  // Shunt voltage LSB is 10uV: across 0.1 ohm that is 0.1mA per LSB,
+  // clamped to the full scale of the configured PGA gain.
+  static const int32_t fullScale[] = { 4000, 8000, 16000, 32000 };
+  int32_t shunt = loadMilliAmps * 10, fs = fullScale[(regs[REG_CONFIG] >> 11) & 3];
+  if(shunt >  fs) shunt =  fs;
+  if(shunt < -fs) shunt = -fs;
+  regs[REG_SHUNT] = (uint16_t)(int16_t)shunt;
+
+  uint8_t mode = regs[REG_CONFIG] & 7;
+  bool    cnvr = (mode != 0) && (mode != 4) && !conversionCleared &&
+                 (nowMicros() - conversionStart >= conversionMicros());
+
+  uint16_t bus = (uint16_t)(loadMilliVolts / 4);
+  regs[REG_BUS] = (uint16_t)(bus << 3) | (cnvr ? 0x02 : 0);
+
+  int32_t current = (int32_t)(int16_t)regs[REG_SHUNT] *
+                    regs[REG_CALIBRATION] / 4096;
+  regs[REG_CURRENT] = (uint16_t)(int16_t)current;
+  regs[REG_POWER]   = (uint16_t)((current < 0 ? -current : current) *
+                      (int32_t)bus / 5000);
+}
+
+bool INA219Model::write(const uint8_t *data, size_t len) {
+  if(!len) return true;
+  pointer = data[0] % 6;
+  if(len >= 3) {
+    uint16_t value = ((uint16_t)data[1] << 8) | data[2];
+    if(pointer == REG_CONFIG) {
+      if(value & 0x8000) {
+        powerOnReset();
+        return true;
+      }
+      regs[REG_CONFIG]  = value;
+      conversionStart   = nowMicros();
+      conversionCleared = false;
+    } else if(pointer == REG_CALIBRATION) {
+      regs[REG_CALIBRATION] = value & 0xFFFE;
+    }
+    update();
+  }
+  return true;
+}
+
+size_t INA219Model::read(uint8_t *data, size_t len) {
+  update();
+  uint16_t value = regs[pointer];
+  size_t   n     = 0;
+  if(len > 0) { data[n++] = value >> 8; }
+  if(len > 1) { data[n++] = value & 0xFF; }
+  if(n && maxClock && (Wire.getClock() > maxClock)) data[0] ^= 0x80; // Misread
+
+  if(pointer == REG_POWER) { // Reading power clears CNVR
+    if((regs[REG_CONFIG] & 7) >= 5) conversionStart   = nowMicros();
+    else                            conversionCleared = true;
+  }
+  if(onRead) onRead(pointer);
+  return n;
+}
+
+} // namespace host
@@ -0,0 +1,69 @@
+// I2C device models for the host build: the SSD1306 OLED panel and the
+// INA219 current monitor found on the charger board.
+
+#ifndef _HOST_HOSTDEVICES_H_
+#define _HOST_HOSTDEVICES_H_
+
+#include "ArduinoHost.h"
+
+namespace host {
+
+// SSD1306 controller in horizontal addressing mode. Decodes the command
+// stream (PAGEADDR/COLUMNADDR windows in particular) and keeps a copy of
+// the panel's GDDRAM so it can be compared against the sketch framebuffer.
+class SSD1306Panel : public I2CDevice {
+ public:
+  SSD1306Panel(uint8_t w = 128, uint8_t h = 32);
+
+  bool   write(const uint8_t *data, size_t len);
+  size_t read(uint8_t *data, size_t len);
+
+  // Panel RAM in the same page-major layout as Adafruit_SSD1306's buffer.
+  const uint8_t *ram(void) const { return gddram; }
+  uint16_t       ramSize(void) const { return width * pages; }
+
+  uint32_t dataBytes;    // GDDRAM bytes received
+  uint32_t commandBytes; // Command and argument bytes received
+  uint32_t maxClock;     // Fastest Wire clock it acknowledges, 0 = any
+
+ private:
+  void command(uint8_t c);
+
+  uint8_t width, pages;
+  uint8_t gddram[128 * 8];
+  uint8_t colStart, colEnd, pageStart, pageEnd, col, page;
+  uint8_t pending[7], pendingLen, pendingNeed;
+};
+
+// INA219 register file with a settable load. Current, shunt, bus and
+// power registers follow the datasheet for a 0.1 ohm shunt; conversion
+// ready (CNVR) timing follows the configured ADC mode.
+class INA219Model : public I2CDevice {
+ public:
+  INA219Model();
+
+  bool   write(const uint8_t *data, size_t len);
+  size_t read(uint8_t *data, size_t len);
+
+  void     setLoad(int32_t milliAmps, uint32_t busMilliVolts = 5000);
+  void     powerOnReset(void);
+  uint16_t reg(uint8_t r) const { return regs[r & 7]; }
+
+  std::function<void(uint8_t reg)> onRead; // Called for every register read
+  uint32_t maxClock; // Fastest Wire clock it reads back right at, 0 = any
+
+ private:
+  uint32_t conversionMicros(void) const;
+  void     update(void);
+
+  uint16_t regs[6];
+  uint8_t  pointer;
+  int32_t  loadMilliAmps;
+  uint32_t loadMilliVolts;
+  uint64_t conversionStart;
+  bool     conversionCleared;
+};
+
+} // namespace host
+
+#endif // _HOST_HOSTDEVICES_H_
@@ -0,0 +1,242 @@
+// Checks that what Adafruit_SSD1306 sends leaves the panel model showing
+// its buffer, with and without frame diffing (setFrameDiff()), and that
+// its byte-column drawChar() draws what Adafruit_GFX's does.
+//
+// Covers turning frame diffing on when the panel holds the complement of
+// what is then drawn (clear, send, enable, fill white, send), turning it
+// on part way through a flush, and random fillRect() calls in every
+// rotation on a 128x64 display sent with display() or flushStep(). Then
+// random characters in every size, color, text mode and rotation, off the
+// page grid and clipped at the edges, drawn on one display with
+// drawChar() and on another with Adafruit_GFX::drawChar(). Last, the
+// sketch's pre-rendered labels (labels.h) blitted with drawPageBitmap()
+// against print() of their text.
+//
+// Usage: display_test [-n rounds] [-s seed]
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "HostDevices.h"
+#include "labels.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// Gives the test the buffer without marking it all changed, as
+// getBuffer() does
+class TestDisplay : public Adafruit_SSD1306 {
+ public:
+  TestDisplay(uint8_t w, uint8_t h) : Adafruit_SSD1306(w, h, &Wire) {}
+  const uint8_t *frame(void) const { return buffer; }
+  uint16_t       frameSize(void) const { return WIDTH * ((HEIGHT + 7) / 8); }
+};
+
+static unsigned failures = 0;
+
+static void check(const host::SSD1306Panel &panel, const TestDisplay &oled,
+  const char *what) {
+  const uint8_t *ram = panel.ram(), *frame = oled.frame();
+  uint16_t differ = 0;
+  for(uint16_t i=0; i<panel.ramSize(); i++) differ += (ram[i] != frame[i]);
+  if(differ) {
+    printf("FAIL: %s: %u of %u panel bytes differ from the buffer\n", what,
+      differ, panel.ramSize());
+    failures++;
+  }
+}
+
+static void same(const TestDisplay &a, const TestDisplay &b,
+  const char *what) {
+  const uint8_t *fa = a.frame(), *fb = b.frame();
+  uint16_t differ = 0;
+  for(uint16_t i=0; i<a.frameSize(); i++) differ += (fa[i] != fb[i]);
+  if(differ) {
+    printf("FAIL: %s: %u of %u buffer bytes differ\n", what, differ,
+      a.frameSize());
+    failures++;
+  }
+}
+
+// Complement of what is drawn next: the shadow must not be guessed
+static void complementTest(void) {
+  host::SSD1306Panel panel(128, 32);
+  host::attachI2C(0x3C, &panel);
+  TestDisplay oled(128, 32);
+  oled.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+
+  oled.clearDisplay();
+  oled.display();
+  oled.setFrameDiff(true);
+  oled.fillScreen(SSD1306_WHITE);
+  oled.display();
+  check(panel, oled, "fill white after enabling");
+
+  oled.fillScreen(SSD1306_BLACK);
+  oled.display();
+  check(panel, oled, "fill black");
+  host::detachI2C(0x3C);
+}
+
+// Enabled while a flush is part sent; the rest of that flush does not
+// make up a whole frame
+static void midFlushTest(void) {
+  host::SSD1306Panel panel(128, 64);
+  host::attachI2C(0x3C, &panel);
+  TestDisplay oled(128, 64);
+  oled.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  oled.display();
+
+  oled.fillRect(0, 0, 128, 64, SSD1306_WHITE);
+  oled.beginFlush();
+  for(int i=0; i<5; i++) oled.flushStep();
+  oled.setFrameDiff(true);
+  oled.fillRect(0, 0, 128, 64, SSD1306_BLACK);
+  oled.fillRect(40, 8, 30, 30, SSD1306_WHITE);
+  while(!oled.flushStep());
+  oled.display();
+  check(panel, oled, "enabled part way through a flush");
+  host::detachI2C(0x3C);
+}
+
+static void fuzzTest(unsigned rounds, bool frameDiff) {
+  host::SSD1306Panel panel(128, 64);
+  host::attachI2C(0x3C, &panel);
+  TestDisplay oled(128, 64);
+  oled.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  oled.display();
+  if(frameDiff) oled.setFrameDiff(true);
+
+  char what[64];
+  for(unsigned r=0; r<rounds; r++) {
+    oled.setRotation(rand() & 3);
+    for(int n = rand() % 6; n >= 0; n--) {
+      oled.fillRect(rand() % 140 - 6, rand() % 140 - 6, rand() % 70,
+        rand() % 70, rand() % 3);
+    }
+    if(frameDiff && !(rand() % 50)) oled.setFrameDiff(true); // Start over
+    if(rand() & 1) {
+      oled.display();
+    } else { // In steps, drawing on between them
+      oled.beginFlush();
+      while(!oled.flushStep()) {
+        if(!(rand() % 8)) oled.fillRect(rand() % 128, rand() % 64, 8, 8,
+          SSD1306_INVERSE);
+      }
+      oled.display();
+    }
+    snprintf(what, sizeof(what), "%s round %u",
+      frameDiff ? "frame diff" : "dirty spans", r);
+    check(panel, oled, what);
+    if(failures) break;
+  }
+  host::detachI2C(0x3C);
+}
+
+// drawChar()'s fast path (unrotated cells fully on screen, sizes 1 to 3)
+// and its fallbacks against Adafruit_GFX, drawing over what is there
+static void drawCharTest(unsigned rounds) {
+  TestDisplay fast(128, 64), slow(128, 64);
+  fast.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  slow.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+
+  char what[96];
+  for(unsigned r=0; r<rounds; r++) {
+    uint8_t rotation = (rand() & 1) ? 0 : (rand() & 3); // Mostly fast path
+    fast.setRotation(rotation);
+    slow.setRotation(rotation);
+    boolean cp437 = rand() & 1;
+    fast.cp437(cp437);
+    slow.cp437(cp437);
+    for(int n = rand() % 8; n >= 0; n--) {
+      int16_t       x     = rand() % (fast.width() + 12) - 6,
+                    y     = rand() % (fast.height() + 12) - 6;
+      unsigned char c     = rand() & 0xFF;
+      uint16_t      color = rand() % 3, bg = rand() % 3;
+      uint8_t       size  = rand() % 4 + 1;
+      fast.drawChar(x, y, c, color, bg, size);
+      slow.Adafruit_GFX::drawChar(x, y, c, color, bg, size);
+      snprintf(what, sizeof(what), "drawChar(%d, %d, %u, %u, %u, %u) "
+        "rotation %u round %u", x, y, c, color, bg, size, rotation, r);
+      same(fast, slow, what);
+      if(failures) return;
+    }
+  }
+}
+
+// The labels in labels.h and the text each was made from
+struct Label {
+  const uint8_t *data;
+  uint8_t        width, pages;
+  const char    *text;
+};
+#define LABEL(id, text) { id##_data, id##_width, id##_pages, text }
+static const Label labels[] = {
+  LABEL(label_CHARGE, "CHARGE"), LABEL(label_PAUSED, "PAUSED"),
+  LABEL(label_NOT, "NOT"), LABEL(label_CONNECTED, "CONNECTED")
+};
+
+// drawPageBitmap() of a label against clearing its cell and print()ing
+// its text at the size it was rendered (a page per size step), over
+// whatever is there, in every rotation and clipped at the edges
+static void labelTest(unsigned rounds) {
+  TestDisplay blit(128, 64), text(128, 64);
+  blit.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  text.begin(SSD1306_SWITCHCAPVCC, 0x3C);
+  text.setTextWrap(false);
+  text.setTextColor(SSD1306_WHITE);
+
+  char what[64];
+  for(unsigned r=0; r<rounds; r++) {
+    uint8_t rotation = rand() & 3;
+    blit.setRotation(rotation);
+    text.setRotation(rotation);
+    for(int n = rand() % 4; n >= 0; n--) { // Something to draw over
+      int16_t x = rand() % blit.width(), y = rand() % blit.height(),
+              w = rand() % 40, h = rand() % 40;
+      blit.fillRect(x, y, w, h, SSD1306_INVERSE);
+      text.fillRect(x, y, w, h, SSD1306_INVERSE);
+    }
+
+    const Label &label = labels[rand() % (sizeof(labels) / sizeof(*labels))];
+    int16_t x    = rand() % (blit.width() + label.width) - label.width / 2;
+    uint8_t page = rand() % (blit.height() / 8 + 1);
+    blit.drawPageBitmap(x, page, label.data, label.width, label.pages);
+    text.fillRect(x, page * 8, label.width, label.pages * 8, SSD1306_BLACK);
+    text.setTextSize(label.pages);
+    text.setCursor(x, page * 8);
+    text.print(label.text);
+
+    snprintf(what, sizeof(what), "label %s at %d, page %u, rotation %u",
+      label.text, x, page, rotation);
+    same(blit, text, what);
+    if(failures) return;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  unsigned rounds = 2000, seed = 1;
+  int opt;
+  while((opt = getopt(argc, argv, "n:s:")) != -1) {
+    switch(opt) {
+     case 'n': rounds = atoi(optarg); break;
+     case 's': seed   = atoi(optarg); break;
+     default:
+      fprintf(stderr, "Usage: %s [-n rounds] [-s seed]\n", argv[0]);
+      return 1;
+    }
+  }
+  srand(seed);
+
+  complementTest();
+  midFlushTest();
+  fuzzTest(rounds, false);
+  fuzzTest(rounds, true);
+  drawCharTest(rounds);
+  labelTest(rounds);
+
+  if(failures) return 1;
+  printf("PASS\n");
+  return 0;
+}
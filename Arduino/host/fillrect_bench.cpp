@@ -0,0 +1,132 @@
+// Microbenchmark of Adafruit_SSD1306's page-major fillRect().
+//
+// Checks the override against Adafruit_GFX::fillRect() (one
+// drawFastVLine() per column, as the library did before) on random
+// rectangles in all four rotations, including ones partly off screen,
+// requiring identical buffers after every call. Then times both for the
+// same rectangles, and for the sketch's clear of its text zone.
+//
+// Usage: fillrect_bench [-n rects] [-r rounds] [-s seed]
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+// Gives the benchmark the buffer without marking it all changed, as
+// getBuffer() does
+class BenchDisplay : public Adafruit_SSD1306 {
+ public:
+  BenchDisplay(uint8_t w, uint8_t h) : Adafruit_SSD1306(w, h, &Wire) {}
+  const uint8_t *frame(void) const { return buffer; }
+  uint16_t       frameSize(void) const { return WIDTH * ((HEIGHT + 7) / 8); }
+};
+
+struct Rect {
+  int16_t  x, y, w, h;
+  uint16_t color;
+};
+
+static std::vector<Rect> rects;
+static size_t            rounds = 200;
+
+// The override, or Adafruit_GFX's column-by-column fill
+static void fill(BenchDisplay &oled, const Rect &r, bool generic) {
+  if(generic) oled.Adafruit_GFX::fillRect(r.x, r.y, r.w, r.h, r.color);
+  else        oled.fillRect(r.x, r.y, r.w, r.h, r.color);
+}
+
+static bool checkRotation(BenchDisplay &fast, BenchDisplay &slow,
+  uint8_t rotation) {
+  fast.setRotation(rotation);
+  slow.setRotation(rotation);
+  fast.clearDisplay();
+  slow.clearDisplay();
+  for(size_t i = 0; i < rects.size(); i++) {
+    fill(fast, rects[i], false);
+    fill(slow, rects[i], true);
+    if(memcmp(fast.frame(), slow.frame(), fast.frameSize())) {
+      printf("Rotation %u: buffers differ after fillRect(%d, %d, %d, %d, "
+        "%u)  <-- FAIL\n", rotation, rects[i].x, rects[i].y, rects[i].w,
+        rects[i].h, rects[i].color);
+      return false;
+    }
+  }
+  printf("Rotation %u: identical buffers after %zu rectangles\n", rotation,
+    rects.size());
+  return true;
+}
+
+template<typename F>
+static double nsPerCall(size_t calls, F f) {
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  for(size_t r = 0; r < rounds; r++) f();
+  return std::chrono::duration<double, std::nano>(
+           std::chrono::steady_clock::now() - start).count() /
+         (calls * rounds);
+}
+
+int main(int argc, char *argv[]) {
+  size_t   count = 1000;
+  unsigned seed  = 1;
+  int      opt;
+  while((opt = getopt(argc, argv, "n:r:s:h")) != -1) {
+    switch(opt) {
+     case 'n': count  = atoi(optarg); break;
+     case 'r': rounds = atoi(optarg); break;
+     case 's': seed   = atoi(optarg); break;
+     default:
+      fprintf(stderr, "Usage: %s [-n rects] [-r rounds] [-s seed]\n",
+        argv[0]);
+      return 1;
+    }
+  }
+
+  // Anywhere from a pixel to past the screen, in every color
+  srand(seed);
+  for(size_t i = 0; i < count; i++) {
+    Rect r = { (int16_t)(rand() % 150 - 10), (int16_t)(rand() % 90 - 10),
+               (int16_t)(rand() % 80), (int16_t)(rand() % 50),
+               (uint16_t)(rand() % 3) };
+    rects.push_back(r);
+  }
+
+  BenchDisplay fast(128, 64), slow(128, 64);
+  fast.begin(SSD1306_SWITCHCAPVCC, 0x3C, false, false);
+  slow.begin(SSD1306_SWITCHCAPVCC, 0x3C, false, false);
+
+  bool ok = true;
+  for(uint8_t rotation = 0; rotation < 4; rotation++)
+    ok &= checkRotation(fast, slow, rotation);
+  if(!ok) return 1;
+
+  fast.setRotation(0);
+  slow.setRotation(0);
+  printf("\n%zu random rectangles x %zu rounds, 128x64\n", count, rounds);
+  printf("Adafruit_GFX::fillRect():  %7.1f ns/call\n",
+    nsPerCall(count, [&]() {
+      for(size_t i = 0; i < rects.size(); i++) fill(slow, rects[i], true);
+    }));
+  printf("Adafruit_SSD1306::fillRect(): %4.1f ns/call\n",
+    nsPerCall(count, [&]() {
+      for(size_t i = 0; i < rects.size(); i++) fill(fast, rects[i], false);
+    }));
+
+  // The sketch clearing its text zone, right of the heart
+  Rect zone = { 10, 0, 118, 32, SSD1306_BLACK };
+  printf("Text zone clear, generic:  %7.1f ns\n",
+    nsPerCall(1000, [&]() {
+      for(int i = 0; i < 1000; i++) fill(slow, zone, true);
+    }));
+  printf("Text zone clear, override: %7.1f ns\n",
+    nsPerCall(1000, [&]() {
+      for(int i = 0; i < 1000; i++) fill(fast, zone, false);
+    }));
+  return 0;
+}
@@ -0,0 +1,186 @@
+// Microbenchmark of the current-sample filters in Filters.h.
+//
+// Checks each filter against a straightforward reference (a double mean
+// or EMA, a sort of the window for the median) over random charge
+// currents, then times it against the rolling average getMilliAmps()
+// used before: re-summing 19 of its 20 slots into a uint16_t, which
+// overflows once the slots add up to 64K (3.4A). The reciprocal division
+// Boxcar uses for lengths that are not a power of two is checked against
+// '/' for every sum the samples' full 16-bit range allows.
+//
+// Usage: filter_bench [-n samples] [-r rounds] [-m max mA]
+
+#include <Arduino.h>
+#include "Filters.h"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <vector>
+
+// ---- getMilliAmps()'s previous average -------------------------------------
+
+static uint16_t mA_Average[20] = { 0 };
+static uint8_t  mAIdx = 0;
+
+static int legacyAverage(int current) {
+  uint8_t numberOfAverages = (sizeof(mA_Average) / 2) - 1;
+  mA_Average[mAIdx] = current;
+  mAIdx++;
+  mAIdx = mAIdx > numberOfAverages ? 0 : mAIdx;
+
+  uint16_t rollingAverage = 0;
+  for(int cnt = 0; cnt < numberOfAverages; cnt++)
+    rollingAverage += mA_Average[cnt];
+  return rollingAverage / numberOfAverages;
+}
+
+// ----------------------------------------------------------------------------
+
+static std::vector<uint16_t> samples;
+static size_t                rounds = 2000;
+
+// Worst difference from the exact mean of the last N samples
+template<size_t N, typename F>
+static double meanError(F add) {
+  double worst = 0;
+  for(size_t i = 0; i < samples.size(); i++) {
+    double got = add(samples[i]);
+    if(i + 1 < N) continue;
+    double sum = 0;
+    for(size_t j = i + 1 - N; j <= i; j++) sum += samples[j];
+    worst = std::max(worst, fabs(got - sum / N));
+  }
+  return worst;
+}
+
+template<typename F>
+static double nsPerSample(F add) {
+  volatile uint32_t sink = 0;
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  for(size_t r = 0; r < rounds; r++) {
+    for(size_t i = 0; i < samples.size(); i++) sink += add(samples[i]);
+  }
+  return std::chrono::duration<double, std::nano>(
+           std::chrono::steady_clock::now() - start).count() /
+         (samples.size() * rounds);
+}
+
+template<size_t N>
+static bool checkBoxcar(void) {
+  Boxcar<uint16_t, N> box;
+  double err = meanError<N>([&](uint16_t s) { return box.add(s); });
+  // The mean rounded down
+  bool ok = err < 1.0;
+  printf("Boxcar<%2zu>:  max error %.2f%s\n", N, err, ok ? "" : "  <-- FAIL");
+  return ok;
+}
+
+// Every sum of N 16-bit samples, and a box filled at the extremes
+template<size_t N>
+static bool checkDivide(void) {
+  uint32_t bad = 0;
+  for(uint32_t sum = 0; sum <= N * 65535UL; sum++) {
+    if(FilterMath::Divide<N>::apply(sum) != sum / N) bad++;
+  }
+  static const uint16_t fills[] = { 1, 4000, 60000, 65534, 65535 };
+  for(size_t i = 0; i < sizeof(fills) / sizeof(fills[0]); i++) {
+    Boxcar<uint16_t, N> box;
+    box.fill(fills[i]);
+    if(box.value() != fills[i]) bad++;
+  }
+  printf("Divide<%3zu>: %s\n", N, bad ? "differs from /  <-- FAIL" :
+    "exact to 0xFFFF x N");
+  return !bad;
+}
+
+template<size_t N>
+static bool checkMedian(void) {
+  Median<uint16_t, N> median;
+  bool ok = true;
+  for(size_t i = 0; i < samples.size(); i++) {
+    uint16_t got = median.add(samples[i]);
+    if(i + 1 < N) continue;
+    std::vector<uint16_t> window(samples.begin() + i + 1 - N,
+                                 samples.begin() + i + 1);
+    std::sort(window.begin(), window.end());
+    if(got != window[N / 2]) ok = false;
+  }
+  printf("Median<%2zu>:  %s\n", N, ok ? "matches sorted window" :
+    "differs from sorted window  <-- FAIL");
+  return ok;
+}
+
+template<size_t N>
+static bool checkEma(void) {
+  Ema<uint16_t, N> ema;
+  ema.fill(samples[0]);
+  double exact = samples[0], worst = 0;
+  for(size_t i = 0; i < samples.size(); i++) {
+    exact += (samples[i] - exact) / N;
+    worst = std::max(worst, fabs(ema.add(samples[i]) - exact));
+  }
+  // The accumulator truncates by up to one part in N per step
+  bool ok = worst < 1.5;
+  printf("Ema<%2zu>:     max error %.2f%s\n", N, worst, ok ? "" : "  <-- FAIL");
+  return ok;
+}
+
+int main(int argc, char *argv[]) {
+  size_t count = 4096;
+  int    maxMA = 4000, opt;
+  while((opt = getopt(argc, argv, "n:r:m:h")) != -1) {
+    switch(opt) {
+     case 'n': count  = atoi(optarg); break;
+     case 'r': rounds = atoi(optarg); break;
+     case 'm': maxMA  = atoi(optarg); break;
+     default:
+      fprintf(stderr, "Usage: %s [-n samples] [-r rounds] [-m max mA]\n",
+        argv[0]);
+      return 1;
+    }
+  }
+
+  // A charge current wandering over the range, with jitter and spikes
+  srand(1);
+  double level = maxMA / 2;
+  for(size_t i = 0; i < count; i++) {
+    level += (rand() % 201 - 100) * maxMA / 4000.0;
+    level  = std::max(0.0, std::min((double)maxMA, level));
+    int s  = (int)level + rand() % 21 - 10;
+    if(rand() % 50 == 0) s = rand() % (maxMA + 1);
+    samples.push_back((uint16_t)std::max(0, std::min(maxMA, s)));
+  }
+
+  bool ok = checkBoxcar<16>() & checkBoxcar<20>() & checkEma<16>() &
+            checkMedian<3>() & checkMedian<9>() & checkDivide<3>() &
+            checkDivide<7>() & checkDivide<20>() & checkDivide<100>() &
+            checkDivide<255>();
+  double legacyErr = meanError<20>([](uint16_t s) { return legacyAverage(s); });
+  printf("Previous:    max error %.2f (19 of 20 slots, uint16_t sum)\n\n",
+    legacyErr);
+
+  Boxcar<uint16_t, 16> box16;
+  Boxcar<uint16_t, 20> box20;
+  Ema<uint16_t, 16>    ema16;
+  Median<uint16_t, 3>  median3;
+  Median<uint16_t, 9>  median9;
+  double legacy = nsPerSample([](uint16_t s) { return legacyAverage(s); });
+  printf("%zu samples x %zu rounds, 0 - %d mA\n", count, rounds, maxMA);
+  printf("Previous average: %5.1f ns/sample\n", legacy);
+  printf("Boxcar<16>:       %5.1f ns/sample\n",
+    nsPerSample([&](uint16_t s) { return box16.add(s); }));
+  printf("Boxcar<20>:       %5.1f ns/sample\n",
+    nsPerSample([&](uint16_t s) { return box20.add(s); }));
+  printf("Ema<16>:          %5.1f ns/sample\n",
+    nsPerSample([&](uint16_t s) { return ema16.add(s); }));
+  printf("Median<3>:        %5.1f ns/sample\n",
+    nsPerSample([&](uint16_t s) { return median3.add(s); }));
+  printf("Median<9>:        %5.1f ns/sample\n",
+    nsPerSample([&](uint16_t s) { return median9.add(s); }));
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+// Microbenchmark of the Bluetooth frame decoding.
+//
+// Times decodeBTFrame() against the helpers the sketch used before it
+// (copied below as they were: strcmp for the heartbeat, then memset, copy
+// and atoi for each 3-digit value) over the same mix of data and heartbeat
+// frames, and checks both agree on every frame. Then times the whole
+// receive path, BTFrameParser::feed() byte by byte, for the same frames as
+// text and as protocol v2.
+//
+// Usage: frame_bench [-n frames] [-r rounds]
+
+#include <Arduino.h>
+#include "BTFrameParser.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// ---- The sketch's previous helpers -----------------------------------------
+
+static char buffer[BT_FRAME_LENGTH + 1];
+static char btValue[4] = { 0 };
+static char heartBeat[11] = { '\0' };
+
+static bool extractHeartBeatFromBTdata(int startIdx, int endIdx) {
+  int hbIdx = 0;
+  memset(heartBeat, '\0', sizeof(heartBeat));
+  for(int cnt = startIdx; cnt <= endIdx; cnt++)
+    heartBeat[hbIdx++] = buffer[cnt];
+  char key[] = "HEARTBEAT";
+  return strcmp(heartBeat, key) == 0;
+}
+
+static int extractDataFromBTdata(int startIdx, int endIdx) {
+  memset(btValue, 0, sizeof(btValue));
+  int btValueIdx = 0;
+  for(int cnt = startIdx; cnt <= endIdx; cnt++)
+    btValue[btValueIdx++] = buffer[cnt];
+  return atoi(btValue);
+}
+
+struct Legacy {
+  bool heartbeat, pluggedIn;
+  int  battery, maxCharge, minCharge;
+};
+
+static void legacyDecode(Legacy &out) {
+  out.pluggedIn = buffer[17] == '1';
+  out.heartbeat = extractHeartBeatFromBTdata(8, 16);
+  if(out.heartbeat) {
+    out.battery = out.maxCharge = out.minCharge = 0;
+  } else {
+    out.battery   = extractDataFromBTdata(8, 10);
+    out.maxCharge = extractDataFromBTdata(11, 13);
+    out.minCharge = extractDataFromBTdata(14, 16);
+  }
+}
+
+// ----------------------------------------------------------------------------
+
+static double nsPerFrame(std::chrono::steady_clock::time_point start,
+                         size_t frames) {
+  return std::chrono::duration<double, std::nano>(
+           std::chrono::steady_clock::now() - start).count() / frames;
+}
+
+int main(int argc, char *argv[]) {
+  size_t count = 4096, rounds = 200;
+  int    opt;
+  while((opt = getopt(argc, argv, "n:r:h")) != -1) {
+    switch(opt) {
+     case 'n': count  = atoi(optarg); break;
+     case 'r': rounds = atoi(optarg); break;
+     default:
+      fprintf(stderr, "Usage: %s [-n frames] [-r rounds]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  // One heartbeat in four, as the app sends them between level changes
+  std::vector<std::string> frames, binary;
+  std::vector<uint32_t>    times;
+  srand(1);
+  for(size_t i = 0; i < count; i++) {
+    char     f[32];
+    uint8_t  b[BT_MAX_PAYLOAD + 4], length;
+    uint32_t t = rand() % 86400;
+    uint32_t fields[5] = { (uint32_t)(rand() & 1), (uint32_t)(rand() % 101),
+      (uint32_t)(rand() % 101), (uint32_t)(rand() % 101), t };
+    if((i & 3) == 3) {
+      snprintf(f, sizeof(f), "%02u:%02u:%02uHEARTBEAT%u", t / 3600,
+        (t / 60) % 60, t % 60, fields[0]);
+      fields[1] = t;
+      length = encodeBTFrame(b, BT_HEARTBEAT, fields, 2);
+    } else {
+      snprintf(f, sizeof(f), "%02u:%02u:%02u%03u%03u%03u%u", t / 3600,
+        (t / 60) % 60, t % 60, fields[1], fields[2], fields[3], fields[0]);
+      length = encodeBTFrame(b, BT_LEVELS, fields, 5);
+    }
+    frames.push_back(f);
+    binary.push_back(std::string((char *)b, length));
+    times.push_back(t);
+  }
+
+  // All must agree before their speed means anything
+  char          parsed[BT_FRAME_LENGTH + 1];
+  BTFrameParser parser(parsed);
+  for(size_t i = 0; i < count; i++) {
+    const std::string &f = frames[i];
+    memcpy(buffer, f.c_str(), sizeof(buffer));
+    Legacy  old;
+    BTFrame frame;
+    legacyDecode(old);
+    bool    fed = false;
+    for(size_t j = 0; j < binary[i].size(); j++)
+      fed = parser.feed(binary[i][j]);
+    if(!decodeBTFrame(buffer, frame) || !fed ||
+       memcmp(&frame, &parser.decoded, sizeof(frame)) ||
+       (frame.heartbeat != old.heartbeat) ||
+       (frame.pluggedIn != old.pluggedIn) ||
+       (frame.battery != old.battery) ||
+       (frame.maxCharge != old.maxCharge) ||
+       (frame.minCharge != old.minCharge) ||
+       (frame.seconds != times[i])) {
+      fprintf(stderr, "Mismatch on frame %s\n", f.c_str());
+      return 1;
+    }
+  }
+
+  // The sketch decodes out of its one frame buffer, so copy each frame
+  // there first in both loops
+  volatile uint32_t sink = 0;
+  std::chrono::steady_clock::time_point start =
+    std::chrono::steady_clock::now();
+  for(size_t r = 0; r < rounds; r++) {
+    for(size_t i = 0; i < count; i++) {
+      memcpy(buffer, frames[i].c_str(), sizeof(buffer));
+      Legacy old;
+      legacyDecode(old);
+      sink += old.battery + old.maxCharge + old.minCharge + old.heartbeat;
+    }
+  }
+  double legacy = nsPerFrame(start, count * rounds);
+
+  start = std::chrono::steady_clock::now();
+  for(size_t r = 0; r < rounds; r++) {
+    for(size_t i = 0; i < count; i++) {
+      memcpy(buffer, frames[i].c_str(), sizeof(buffer));
+      BTFrame frame;
+      decodeBTFrame(buffer, frame);
+      sink += frame.battery + frame.maxCharge + frame.minCharge +
+              frame.heartbeat;
+    }
+  }
+  double fused = nsPerFrame(start, count * rounds);
+
+  size_t textBytes = 0, binaryBytes = 0;
+  start = std::chrono::steady_clock::now();
+  for(size_t r = 0; r < rounds; r++) {
+    for(size_t i = 0; i < count; i++) {
+      const std::string &f = frames[i];
+      for(size_t j = 0; j < f.size(); j++) {
+        if(parser.feed(f[j])) {
+          BTFrame frame;
+          decodeBTFrame(parsed, frame);
+          sink += frame.battery;
+        }
+      }
+      textBytes += f.size();
+    }
+  }
+  double text = nsPerFrame(start, count * rounds);
+
+  start = std::chrono::steady_clock::now();
+  for(size_t r = 0; r < rounds; r++) {
+    for(size_t i = 0; i < count; i++) {
+      const std::string &b = binary[i];
+      for(size_t j = 0; j < b.size(); j++) {
+        if(parser.feed(b[j])) sink += parser.decoded.battery;
+      }
+      binaryBytes += b.size();
+    }
+  }
+  double v2 = nsPerFrame(start, count * rounds);
+
+  printf("%zu frames x %zu rounds, sizeof(BTFrame) = %zu\n", count, rounds,
+    sizeof(BTFrame));
+  printf("Previous helpers: %6.1f ns/frame\n", legacy);
+  printf("decodeBTFrame:    %6.1f ns/frame (%.1fx)\n", fused, legacy / fused);
+  printf("Receive text:     %6.1f ns/frame, %4.1f bytes/frame\n", text,
+    (double)textBytes / (count * rounds));
+  printf("Receive v2:       %6.1f ns/frame, %4.1f bytes/frame (%.1fx, %.1fx)\n",
+    v2, (double)binaryBytes / (count * rounds), text / v2,
+    (double)textBytes / binaryBytes);
+  return 0;
+}
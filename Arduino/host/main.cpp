@@ -0,0 +1,88 @@
+// Runs the phone charger sketch on the host.
+//
+// The SSD1306 panel and INA219 models are attached to the Wire bus, the
+// HC-05 'connected' pin reads HIGH and each Bluetooth frame given on the
+// command line is queued before one pass of loop(). Afterwards bus
+// traffic, pin changes and the panel contents are reported.
+//
+// Usage: charger_host [-l loops] [-m milliamps] [-s] [-p] [frame ...]
+//   -l  number of loop() passes (default: number of frames, at least 1)
+//   -m  charge current seen by the INA219 (default 500)
+//   -s  echo the sketch's Serial output
+//   -p  print the panel contents as text
+//   frame  18-character BT frame: hh:MM:ss, battery %, max %, min %,
+//          plugged in (0/1), e.g. 12:00:000800900301 or 12:00:05HEARTBEAT1
+
+#include <Arduino.h>
+#include "HostDevices.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CONNECTED_STATE_PIN 10 ///< HC-05 STATE output, as in the sketch
+
+static void usage(const char *argv0) {
+  fprintf(stderr,
+    "Usage: %s [-l loops] [-m milliamps] [-s] [-p] [frame ...]\n", argv0);
+  exit(1);
+}
+
+static void printPanel(const host::SSD1306Panel &panel, uint8_t w,
+  uint8_t h) {
+  const uint8_t *ram = panel.ram();
+  for(uint8_t y=0; y<h; y++) {
+    for(uint8_t x=0; x<w; x++)
+      putchar((ram[(y / 8) * w + x] & (1 << (y & 7))) ? '#' : '.');
+    putchar('\n');
+  }
+}
+
+int main(int argc, char *argv[]) {
+  long loops = -1, milliAmps = 500;
+  bool showPanel = false;
+  int  opt;
+  while((opt = getopt(argc, argv, "l:m:sp")) != -1) {
+    switch(opt) {
+     case 'l': loops         = atol(optarg); break;
+     case 'm': milliAmps     = atol(optarg); break;
+     case 's': host::serialEcho = true;      break;
+     case 'p': showPanel     = true;         break;
+     default:  usage(argv[0]);
+    }
+  }
+  int frames = argc - optind;
+  if(loops < 0) loops = frames ? frames : 1;
+
+  host::SSD1306Panel panel(128, 32);
+  host::INA219Model  ina219;
+  host::attachI2C(0x3C, &panel);
+  host::attachI2C(0x40, &ina219);
+  host::setPinInput(CONNECTED_STATE_PIN, HIGH);
+  ina219.setLoad(milliAmps);
+
+  setup();
+  for(long i=0; i<loops; i++) {
+    if(i < frames) host::btInject(argv[optind + i], strlen(argv[optind + i]));
+    loop();
+  }
+
+  printf("\n%ld loop() passes in %.3f s\n", loops, host::nowMicros() / 1e6);
+  for(std::map<uint8_t, host::BusStats>::const_iterator it =
+      host::busStats.begin(); it != host::busStats.end(); ++it) {
+    const host::BusStats &s = it->second;
+    printf("I2C 0x%02X: %u transactions, %u bytes written, %u read, "
+      "%.1f ms on the wire\n", it->first, s.transactions, s.bytesWritten,
+      s.bytesRead, s.wireMicros / 1000.0);
+  }
+  printf("Panel: %u data bytes, %u command bytes\n", panel.dataBytes,
+    panel.commandBytes);
+  printf("Pin changes: %u", (unsigned)host::pinLog.size());
+  static const uint8_t pins[] = { 3, 5, 9 };
+  for(uint8_t i=0; i<sizeof(pins); i++)
+    printf(", D%u=%d", pins[i], host::pinOutput(pins[i]));
+  printf("\nBT sent: %u bytes\n", (unsigned)host::btTx.size());
+  if(showPanel) printPanel(panel, 128, 32);
+  return 0;
+}
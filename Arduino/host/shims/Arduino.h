@@ -0,0 +1,76 @@
+// Host (Linux) stand-in for the Arduino core header.
+//
+// Only the parts of the Arduino API used by the sketch and the bundled
+// Adafruit libraries are provided. Pin and bus activity is recorded by
+// ArduinoHost.cpp so it can be inspected from the host runner.
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "binary.h"
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+// No separate flash address space on the host
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(addr)  (*(const unsigned char *)(addr))
+#define pgm_read_word(addr)  (*(const uint16_t *)(addr))
+#define pgm_read_dword(addr) (*(const uint32_t *)(addr))
+#define pgm_read_pointer(addr) (*(void * const *)(addr)) // 64-bit pointers
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+class __FlashStringHelper;
+#define F(string_literal) \
+  (reinterpret_cast<const __FlashStringHelper *>(string_literal))
+
+#define lowByte(w)  ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define bit(b)      (1UL << (b))
+
+#define noInterrupts()
+#define interrupts()
+
+unsigned long millis(void);
+unsigned long micros(void);
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+void          yield(void);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int  digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int val);
+int  analogRead(uint8_t pin);
+
+#include "Print.h"
+#include "Stream.h"
+#include "HardwareSerial.h"
+
+// Sketch entry points, provided by the sketch itself
+void setup(void);
+void loop(void);
+
+#endif // _HOST_ARDUINO_H_
@@ -0,0 +1,284 @@
+// Host implementations of the Arduino core, Wire, SPI and SoftwareSerial
+// APIs used by the sketch, plus the recording state in ArduinoHost.h.
+
+#include "Arduino.h"
+#include "ArduinoHost.h"
+#include "EEPROM.h"
+#include "SoftwareSerial.h"
+#include "SPI.h"
+#include "Wire.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <deque>
+#include <thread>
+
+namespace host {
+
+std::vector<PinEvent>       pinLog;
+std::map<uint8_t, BusStats> busStats;
+std::string                 btTx;
+uint32_t                    btOverflows = 0;
+bool                        serialEcho  = false;
+std::string                 serialOut;
+uint32_t                    eepromWrites = 0;
+uint8_t                     eeprom[1024] = { 0 };
+
+// Starts erased, as a new chip
+static struct EraseEEPROM {
+  EraseEEPROM() { memset(eeprom, 0xFF, sizeof(eeprom)); }
+} eraseEEPROM;
+
+static std::map<uint8_t, I2CDevice *> i2cDevices;
+static std::map<uint8_t, int>         pinInputs, pinOutputs;
+static std::deque<uint8_t>            btRx;
+static uint64_t                       btLineFree = 0;
+
+static const std::chrono::steady_clock::time_point startTime =
+  std::chrono::steady_clock::now();
+
+uint32_t yieldMicros = 50;
+
+static bool     virtualClock = false;
+static uint64_t virtualNow   = 0;
+static std::multimap<uint64_t, std::function<void()> > events;
+
+uint64_t nowMicros(void) {
+  if(virtualClock) return virtualNow;
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - startTime).count();
+}
+
+void setVirtualTime(bool on) {
+  virtualClock = on;
+  virtualNow   = 0;
+}
+
+bool virtualTime(void) { return virtualClock; }
+
+void advance(uint64_t us) {
+  uint64_t until = virtualNow + us;
+  while(!events.empty() && events.begin()->first <= until) {
+    // Take the event off the queue first, it may schedule others
+    std::function<void()> event = events.begin()->second;
+    if(events.begin()->first > virtualNow) virtualNow = events.begin()->first;
+    events.erase(events.begin());
+    event();
+  }
+  virtualNow = until;
+}
+
+void schedule(uint64_t us, const std::function<void()> &event) {
+  events.insert(std::make_pair(us, event));
+}
+
+void setPinInput(uint8_t pin, int value) { pinInputs[pin] = value; }
+
+int pinOutput(uint8_t pin) {
+  std::map<uint8_t, int>::const_iterator it = pinOutputs.find(pin);
+  return (it == pinOutputs.end()) ? LOW : it->second;
+}
+
+static void recordPin(uint8_t pin, int value) {
+  if(pinOutput(pin) == value && pinOutputs.count(pin)) return;
+  pinOutputs[pin] = value;
+  PinEvent e = { nowMicros(), pin, value };
+  pinLog.push_back(e);
+}
+
+void attachI2C(uint8_t address, I2CDevice *device) {
+  i2cDevices[address] = device;
+}
+
+void detachI2C(uint8_t address) { i2cDevices.erase(address); }
+
+void resetBusStats(void) { busStats.clear(); }
+
+static I2CDevice *i2cDevice(uint8_t address) {
+  std::map<uint8_t, I2CDevice *>::const_iterator it = i2cDevices.find(address);
+  return (it == i2cDevices.end()) ? NULL : it->second;
+}
+
+// One START, address byte, 'len' payload bytes and STOP: 9 bit times per
+// byte plus roughly two for the START/STOP conditions.
+static void recordI2C(uint8_t address, uint32_t clock, size_t len,
+  bool isRead) {
+  BusStats &s = busStats[address];
+  s.transactions++;
+  if(isRead) s.bytesRead    += len;
+  else       s.bytesWritten += len;
+  uint64_t us = ((len + 1) * 9 + 2) * 1000000ULL / (clock ? clock : 100000);
+  s.wireMicros += us;
+  if(virtualClock) advance(us);
+}
+
+void btInject(const char *data, size_t len) {
+  while(len--) {
+    if(btRx.size() >= _SS_MAX_RX_BUFF) {
+      btOverflows++;
+      data++;
+      continue;
+    }
+    btRx.push_back((uint8_t)*data++);
+  }
+}
+
+void btInject(const std::string &data) { btInject(data.data(), data.size()); }
+
+void btSend(const std::string &data, uint32_t baud) {
+  uint64_t byteMicros = 10 * 1000000ULL / baud;
+  if(btLineFree < virtualNow) btLineFree = virtualNow;
+  for(size_t i=0; i<data.size(); i++) {
+    btLineFree += byteMicros;
+    char c = data[i];
+    schedule(btLineFree, [c]() { btInject(&c, 1); });
+  }
+}
+
+} // namespace host
+
+// CORE --------------------------------------------------------------------
+
+unsigned long millis(void) { return (unsigned long)(host::nowMicros() / 1000); }
+unsigned long micros(void) { return (unsigned long)host::nowMicros(); }
+
+void delay(unsigned long ms) {
+  if(host::virtualClock) host::advance(ms * 1000ULL);
+  else std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  if(host::virtualClock) host::advance(us);
+  else std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void) {
+  if(host::virtualClock) host::advance(host::yieldMicros);
+}
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+void digitalWrite(uint8_t pin, uint8_t val) { host::recordPin(pin, val ? HIGH : LOW); }
+void analogWrite(uint8_t pin, int val) { host::recordPin(pin, val); }
+int  analogRead(uint8_t pin) { (void)pin; return 0; }
+
+int digitalRead(uint8_t pin) {
+  std::map<uint8_t, int>::const_iterator it = host::pinInputs.find(pin);
+  return (it == host::pinInputs.end()) ? LOW : it->second;
+}
+
+// SERIAL ------------------------------------------------------------------
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::write(uint8_t c) {
+  host::serialOut += (char)c;
+  if(host::serialEcho) fputc(c, stdout);
+  return 1;
+}
+
+// SPI ---------------------------------------------------------------------
+
+SPIClass SPI;
+
+// EEPROM ------------------------------------------------------------------
+
+EEPROMClass EEPROM;
+
+// WIRE --------------------------------------------------------------------
+
+TwoWire Wire;
+
+TwoWire::TwoWire() : clock(100000UL), txAddress(0), txLength(0),
+  transmitting(false), rxIndex(0), rxLength(0) {
+}
+
+void TwoWire::begin(void) {
+  rxIndex = rxLength = 0;
+  txLength = 0;
+  transmitting = false;
+}
+
+void TwoWire::setClock(uint32_t c) { clock = c; }
+
+void TwoWire::beginTransmission(uint8_t address) {
+  transmitting = true;
+  txAddress    = address;
+  txLength     = 0;
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if(!transmitting || txLength >= BUFFER_LENGTH) return 0;
+  txBuffer[txLength++] = data;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t quantity) {
+  size_t n = 0;
+  while(quantity-- && write(*data++)) n++;
+  return n;
+}
+
+// Return codes match the AVR core: 0 success, 2 address NACK,
+// 3 data NACK.
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  transmitting = false;
+  host::recordI2C(txAddress, clock, txLength, false);
+  host::I2CDevice *dev = host::i2cDevice(txAddress);
+  if(!dev) return 2;
+  return dev->write(txBuffer, txLength) ? 0 : 3;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity,
+  bool sendStop) {
+  (void)sendStop;
+  if(quantity > BUFFER_LENGTH) quantity = BUFFER_LENGTH;
+  rxIndex = rxLength = 0;
+  host::I2CDevice *dev = host::i2cDevice(address);
+  if(dev) rxLength = (uint8_t)dev->read(rxBuffer, quantity);
+  host::recordI2C(address, clock, rxLength, true);
+  return rxLength;
+}
+
+int TwoWire::available(void) { return rxLength - rxIndex; }
+
+int TwoWire::read(void) {
+  return (rxIndex < rxLength) ? rxBuffer[rxIndex++] : -1;
+}
+
+int TwoWire::peek(void) {
+  return (rxIndex < rxLength) ? rxBuffer[rxIndex] : -1;
+}
+
+// SOFTWARESERIAL ----------------------------------------------------------
+
+SoftwareSerial::SoftwareSerial(uint8_t receivePin, uint8_t transmitPin,
+  bool inverseLogic) {
+  (void)receivePin; (void)transmitPin; (void)inverseLogic;
+}
+
+void SoftwareSerial::begin(long speed) { (void)speed; }
+
+bool SoftwareSerial::overflow(void) {
+  bool ret = host::btOverflows != 0;
+  host::btOverflows = 0;
+  return ret;
+}
+
+int SoftwareSerial::available(void) { return (int)host::btRx.size(); }
+
+int SoftwareSerial::read(void) {
+  if(host::btRx.empty()) return -1;
+  uint8_t c = host::btRx.front();
+  host::btRx.pop_front();
+  return c;
+}
+
+int SoftwareSerial::peek(void) {
+  return host::btRx.empty() ? -1 : host::btRx.front();
+}
+
+size_t SoftwareSerial::write(uint8_t byte) {
+  host::btTx += (char)byte;
+  return 1;
+}
@@ -0,0 +1,100 @@
+// Host-side control and inspection of the Arduino shims.
+//
+// Everything the sketch can observe (time, input pins, I2C devices, the
+// Bluetooth serial link) is driven from here, and everything it does (pin
+// changes, I2C traffic, Bluetooth transmissions) is recorded here.
+
+#ifndef _HOST_ARDUINOHOST_H_
+#define _HOST_ARDUINOHOST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace host {
+
+// TIME --------------------------------------------------------------------
+
+// Microseconds since the host run started (what micros() reports).
+uint64_t nowMicros(void);
+
+// Virtual time: delay(), delayMicroseconds() and yield() advance the clock
+// instead of sleeping, I2C transfers take their estimated wire time and
+// scheduled events fire as the clock passes them. Must be selected before
+// setup() runs; the clock starts at zero.
+void setVirtualTime(bool on);
+bool virtualTime(void);
+
+// Move the virtual clock forward, firing due events in time order.
+void advance(uint64_t us);
+
+// Run 'event' when the virtual clock reaches 'us' (or on the next advance
+// if that time has passed). Events may schedule further events.
+void schedule(uint64_t us, const std::function<void()> &event);
+
+extern uint32_t yieldMicros; // Virtual time taken by each yield()
+
+// PINS --------------------------------------------------------------------
+
+struct PinEvent {
+  uint64_t us;    // Time of the change
+  uint8_t  pin;   // Arduino pin number
+  int      value; // New level (digitalWrite) or duty (analogWrite)
+};
+
+extern std::vector<PinEvent> pinLog; // Every output change, in order
+
+void setPinInput(uint8_t pin, int value); // Level seen by digitalRead()
+int  pinOutput(uint8_t pin);              // Last level written
+
+// I2C ---------------------------------------------------------------------
+
+// A device model attached to the host Wire bus.
+class I2CDevice {
+ public:
+  virtual ~I2CDevice() {}
+  // Master wrote 'len' bytes in one transaction. Return false to NACK.
+  virtual bool   write(const uint8_t *data, size_t len) = 0;
+  // Master reads 'len' bytes; return the number supplied.
+  virtual size_t read(uint8_t *data, size_t len) = 0;
+};
+
+struct BusStats {
+  uint32_t transactions; // START...STOP sequences addressed to the device
+  uint32_t bytesWritten; // Payload bytes, master to device
+  uint32_t bytesRead;    // Payload bytes, device to master
+  uint64_t wireMicros;   // Estimated time on the wire at the clock in use
+};
+
+void attachI2C(uint8_t address, I2CDevice *device);
+void detachI2C(uint8_t address);
+
+extern std::map<uint8_t, BusStats> busStats; // Per-address bus traffic
+void resetBusStats(void);
+
+// BLUETOOTH SERIAL --------------------------------------------------------
+
+void btInject(const char *data, size_t len); // Bytes "sent by the phone"
+void btInject(const std::string &data);
+// Virtual time only: bytes arrive one by one at the line rate (10 bits
+// per byte), after anything still being sent.
+void btSend(const std::string &data, uint32_t baud = 9600);
+extern std::string btTx;                     // Bytes sent by the sketch
+extern uint32_t    btOverflows;              // RX bytes lost to a full buffer
+
+// EEPROM ------------------------------------------------------------------
+
+extern uint8_t  eeprom[1024]; // Contents, erased (0xFF) at the start
+extern uint32_t eepromWrites; // Bytes changed
+
+// DEBUG SERIAL ------------------------------------------------------------
+
+extern bool        serialEcho; // Copy Serial output to stdout
+extern std::string serialOut;  // Everything printed on Serial
+
+} // namespace host
+
+#endif // _HOST_ARDUINOHOST_H_
@@ -0,0 +1,41 @@
+// Host stand-in for the Arduino EEPROM library.
+//
+// The 1KB of an ATmega328 is held in host::eeprom, which starts erased
+// (0xFF) and can be set up or inspected by the host; writes that change a
+// byte are counted in host::eepromWrites.
+
+#ifndef _HOST_EEPROM_H_
+#define _HOST_EEPROM_H_
+
+#include "Arduino.h"
+#include "ArduinoHost.h"
+
+class EEPROMClass {
+ public:
+  uint8_t  read(int idx) { return host::eeprom[idx % E2END_SIZE]; }
+  void     write(int idx, uint8_t val) {
+    uint8_t &cell = host::eeprom[idx % E2END_SIZE];
+    if(cell != val) host::eepromWrites++;
+    cell = val;
+  }
+  void     update(int idx, uint8_t val) { if(read(idx) != val) write(idx, val); }
+  uint16_t length(void) { return E2END_SIZE; }
+
+  template<typename T> T &get(int idx, T &t) {
+    uint8_t *p = (uint8_t *)&t;
+    for(size_t n = 0; n < sizeof(T); n++) p[n] = read(idx + n);
+    return t;
+  }
+  template<typename T> const T &put(int idx, const T &t) {
+    const uint8_t *p = (const uint8_t *)&t;
+    for(size_t n = 0; n < sizeof(T); n++) update(idx + n, p[n]);
+    return t;
+  }
+
+ private:
+  enum { E2END_SIZE = sizeof(host::eeprom) };
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // _HOST_EEPROM_H_
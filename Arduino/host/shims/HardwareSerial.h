@@ -0,0 +1,25 @@
+// Host stand-in for the Arduino hardware UART ("Serial").
+// Output goes to stdout when host::serialEcho is set.
+
+#ifndef _HOST_HARDWARESERIAL_H_
+#define _HOST_HARDWARESERIAL_H_
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+ public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end(void) {}
+
+  int    available(void) { return 0; }
+  int    read(void) { return -1; }
+  int    peek(void) { return -1; }
+  size_t write(uint8_t c);
+  using Print::write;
+
+  operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // _HOST_HARDWARESERIAL_H_
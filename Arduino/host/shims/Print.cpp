@@ -0,0 +1,116 @@
+// Host stand-in for the Arduino Print and Stream classes.
+
+#include "Arduino.h"
+
+#include <stdio.h>
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+  size_t n = 0;
+  while(size--) {
+    if(write(*buffer++)) n++;
+    else break;
+  }
+  return n;
+}
+
+size_t Print::write(const char *str) {
+  if(!str) return 0;
+  return write((const uint8_t *)str, strlen(str));
+}
+
+size_t Print::print(const __FlashStringHelper *s) {
+  return write(reinterpret_cast<const char *>(s));
+}
+
+size_t Print::print(const char s[])  { return write(s); }
+size_t Print::print(char c)          { return write((uint8_t)c); }
+
+size_t Print::print(unsigned char n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(int n, int base) { return print((long)n, base); }
+
+size_t Print::print(unsigned int n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t Print::print(long n, int base) {
+  if(base == 0) return write((uint8_t)n);
+  if((base == 10) && (n < 0)) {
+    size_t t = print('-');
+    return t + printNumber((unsigned long)-n, 10);
+  }
+  return printNumber((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base) {
+  if(base == 0) return write((uint8_t)n);
+  return printNumber(n, base);
+}
+
+size_t Print::print(double n, int digits) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%.*f", digits, n);
+  return write(buf);
+}
+
+size_t Print::println(void) { return write("\r\n"); }
+
+size_t Print::println(const __FlashStringHelper *s) {
+  return print(s) + println();
+}
+size_t Print::println(const char s[]) { return print(s) + println(); }
+size_t Print::println(char c)         { return print(c) + println(); }
+size_t Print::println(unsigned char n, int base) {
+  return print(n, base) + println();
+}
+size_t Print::println(int n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned int n, int base) {
+  return print(n, base) + println();
+}
+size_t Print::println(long n, int base) { return print(n, base) + println(); }
+size_t Print::println(unsigned long n, int base) {
+  return print(n, base) + println();
+}
+size_t Print::println(double n, int digits) {
+  return print(n, digits) + println();
+}
+
+size_t Print::printNumber(unsigned long n, uint8_t base) {
+  char  buf[8 * sizeof(long) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+
+  *str = '\0';
+  if(base < 2) base = 10;
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while(n);
+
+  return write(str);
+}
+
+// STREAM ------------------------------------------------------------------
+
+int Stream::timedRead(void) {
+  unsigned long start = millis();
+  do {
+    int c = read();
+    if(c >= 0) return c;
+    yield();
+  } while(millis() - start < _timeout);
+  return -1; // -1 indicates timeout
+}
+
+size_t Stream::readBytes(char *buffer, size_t length) {
+  size_t count = 0;
+  while(count < length) {
+    int c = timedRead();
+    if(c < 0) break;
+    *buffer++ = (char)c;
+    count++;
+  }
+  return count;
+}
@@ -0,0 +1,35 @@
+// Host stand-in for the Arduino SPI library. Transfers are discarded;
+// the charger hardware only uses I2C peripherals.
+
+#ifndef _HOST_SPI_H_
+#define _HOST_SPI_H_
+
+#include "Arduino.h"
+
+#define SPI_HAS_TRANSACTION 1
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+class SPISettings {
+ public:
+  SPISettings() {}
+  SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) {
+    (void)clock; (void)bitOrder; (void)dataMode;
+  }
+};
+
+class SPIClass {
+ public:
+  void    begin(void) {}
+  void    end(void) {}
+  void    beginTransaction(SPISettings settings) { (void)settings; }
+  void    endTransaction(void) {}
+  uint8_t transfer(uint8_t data) { (void)data; return 0; }
+};
+
+extern SPIClass SPI;
+
+#endif // _HOST_SPI_H_
@@ -0,0 +1,33 @@
+// Host stand-in for the Arduino SoftwareSerial library.
+//
+// Received bytes are queued with host::btInject(); transmitted bytes are
+// collected in host::btTx.
+
+#ifndef _HOST_SOFTWARESERIAL_H_
+#define _HOST_SOFTWARESERIAL_H_
+
+#include "Arduino.h"
+
+#define _SS_MAX_RX_BUFF 64 ///< Same RX buffer size as the AVR library
+
+class SoftwareSerial : public Stream {
+ public:
+  SoftwareSerial(uint8_t receivePin, uint8_t transmitPin,
+    bool inverseLogic = false);
+
+  void begin(long speed);
+  bool listen(void) { return true; }
+  void end(void) {}
+  bool isListening(void) { return true; }
+  bool overflow(void);
+
+  int    available(void);
+  int    read(void);
+  int    peek(void);
+  size_t write(uint8_t byte);
+  using Print::write;
+
+  operator bool() { return true; }
+};
+
+#endif // _HOST_SOFTWARESERIAL_H_
@@ -0,0 +1,29 @@
+// Host stand-in for the Arduino Stream class.
+
+#ifndef _HOST_STREAM_H_
+#define _HOST_STREAM_H_
+
+#include "Print.h"
+
+class Stream : public Print {
+ public:
+  Stream() : _timeout(1000) {}
+
+  virtual int available(void) = 0;
+  virtual int read(void) = 0;
+  virtual int peek(void) = 0;
+  virtual void flush(void) {}
+
+  void   setTimeout(unsigned long timeout) { _timeout = timeout; }
+  size_t readBytes(char *buffer, size_t length);
+  size_t readBytes(uint8_t *buffer, size_t length) {
+    return readBytes((char *)buffer, length);
+  }
+
+ protected:
+  int timedRead(void);
+
+  unsigned long _timeout; // mS to wait in readBytes()
+};
+
+#endif // _HOST_STREAM_H_
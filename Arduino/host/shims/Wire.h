@@ -0,0 +1,55 @@
+// Host stand-in for the Arduino Wire (I2C) library.
+//
+// Transactions are delivered to the host::I2CDevice attached at the target
+// address and recorded in host::busStats so traffic can be measured.
+// Device models can check getClock() to misbehave above their rated speed.
+
+#ifndef _HOST_WIRE_H_
+#define _HOST_WIRE_H_
+
+#include "Arduino.h"
+
+#define BUFFER_LENGTH 32 ///< Same transmit buffer size as the AVR core
+
+class TwoWire : public Stream {
+ public:
+  TwoWire();
+
+  void    begin(void);
+  void    end(void) {}
+  void    setClock(uint32_t clock);
+  void    beginTransmission(uint8_t address);
+  void    beginTransmission(int address) { beginTransmission((uint8_t)address); }
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+  uint8_t requestFrom(int address, int quantity, int sendStop = 1) {
+    return requestFrom((uint8_t)address, (uint8_t)quantity, sendStop != 0);
+  }
+
+  size_t write(uint8_t data);
+  size_t write(const uint8_t *data, size_t quantity);
+  size_t write(unsigned long n) { return write((uint8_t)n); }
+  size_t write(long n) { return write((uint8_t)n); }
+  size_t write(unsigned int n) { return write((uint8_t)n); }
+  size_t write(int n) { return write((uint8_t)n); }
+  using Print::write;
+
+  int available(void);
+  int read(void);
+  int peek(void);
+
+  uint32_t getClock(void) const { return clock; }
+
+ private:
+  uint32_t clock;
+  uint8_t  txAddress;
+  uint8_t  txBuffer[BUFFER_LENGTH];
+  uint8_t  txLength;
+  bool     transmitting;
+  uint8_t  rxBuffer[BUFFER_LENGTH];
+  uint8_t  rxIndex, rxLength;
+};
+
+extern TwoWire Wire;
+
+#endif // _HOST_WIRE_H_
@@ -0,0 +1 @@
+// Host stand-in for <util/delay.h>; nothing here is used on the host.
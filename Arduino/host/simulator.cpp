@@ -0,0 +1,580 @@
+// Discrete-event simulation of the phone charger under virtual time.
+//
+// A scripted phone sends the 18-byte Bluetooth frames the Android app
+// sends (a data frame whenever the battery level changes, a heartbeat in
+// between) while a battery/charger model feeds the INA219 current register
+// according to the power MOSFET pin. Days of charge cycles run in seconds;
+// at the end the maxCharge/minCharge hysteresis is checked against what
+// the phone reported and what the sketch switched.
+//
+// Usage: charger_sim [-d days] [-c mAh] [-M max%] [-m min%] [-S start%]
+//                    [-C charge mA] [-D drain mA] [-H heartbeat s]
+//                    [-w charge start ms] [-e errors per 1000 frames] [-b]
+//                    [-R INA219 resets per day] [-P level report s] [-T]
+//                    [-A asleep above %] [-F INA219 kHz,display kHz] [-f]
+//                    [-v]
+
+#include <Arduino.h>
+#include <Adafruit_SSD1306.h>
+#include "BTFrameParser.h"
+#include "INA219.h"
+#include "I2CBus.h"
+#include "HostDevices.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+
+#define CONNECTED_STATE_PIN 10 ///< HC-05 STATE output, as in the sketch
+#define PWR_CONTROL_PIN     9  ///< Charge MOSFET (and its LED), HIGH = on
+#define PWR_LED_MILLIAMPS   16 ///< LED current seen by the INA219
+
+#define TICK_MICROS 1000000ULL ///< Battery model step
+#define CAPTURE_ASK_MICROS 5000000ULL ///< Switch to asking for the captures
+#define CONVERSION_MICROS 532 ///< Of each captured sample
+
+extern BTFrameParser btParser; // The sketch's, for its frame counters
+extern INA219        ina219;   // ... and its INA219 driver
+extern I2CBusClient  ina219Bus, displayBus; // ... and their bus arbitration
+extern Adafruit_SSD1306 display;            // ... and the display
+
+struct Settings {
+  double   days;
+  double   capacity;    // mAh
+  int      maxCharge;   // % at which the phone asks to stop
+  int      minCharge;   // % at which the phone asks to start
+  double   startLevel;  // %
+  double   chargeMA;    // Constant-current phase
+  double   drainMA;     // Phone's own consumption
+  uint32_t heartbeat;   // Seconds between heartbeats
+  uint32_t chargeDelay; // ms from power on to the phone drawing current
+  uint32_t errors;      // Frames per 1000 with a byte lost or corrupted
+  bool     binary;      // Answer the charger's HELLO and send v2 frames
+  double   resets;      // INA219 power-on resets (load transients) per day
+  uint32_t reportEvery; // Seconds between level frames at the most
+  bool     captures;    // Ask for the transient captures after switches
+  int      asleepAbove; // App sends nothing while charging beyond this %
+  uint32_t ina219kHz;   // Fastest I2C clock the INA219 reads right at
+  uint32_t displaykHz;  // ... and the display acknowledges, 0 = any
+  bool     frameDiff;   // Display sends only what changed since last sent
+  bool     verbose;
+};
+
+// Phone with a Li-ion battery: constant current to 80%, then a linear
+// taper to zero at 100% (the constant-voltage phase).
+class Phone {
+ public:
+  Phone(const Settings &s, host::INA219Model &ina219) : level(s.startLevel),
+    reported(-1), lastFrame(0), frames(0), damaged(0), bytes(0), v2(false),
+    drawn(0), lastLevelFrame(0), set(s), ina(ina219), powered(false),
+    poweredAt(0), askAt(0), asleep(false) {}
+
+  // Current drawn through the MOSFET, following the pin as the INA219
+  // reads it so that captures see the switch
+  double follow(void) {
+    uint64_t now = host::nowMicros();
+    bool on = host::pinOutput(PWR_CONTROL_PIN) == HIGH;
+    if(on != powered) {
+      if(on) poweredAt = now;
+      if(set.captures) askAt = now + CAPTURE_ASK_MICROS;
+    }
+    powered = on;
+
+    double chargeMA = 0;
+    if(powered && (now - poweredAt >= set.chargeDelay * 1000ULL)) {
+      chargeMA = set.chargeMA;
+      if(level > 80) chargeMA *= (100 - level) / 20;
+      if(chargeMA < 0) chargeMA = 0;
+    }
+    ina.setLoad((int32_t)(chargeMA + (powered ? PWR_LED_MILLIAMPS : 0)));
+    return chargeMA;
+  }
+
+  void tick(void) {
+    uint64_t now = host::nowMicros();
+    double chargeMA = follow();
+
+    // Switch to v2 once the charger has offered it
+    if(set.binary && !v2 && offered()) {
+      uint32_t version = BT_VERSION;
+      uint8_t  hello[BT_MAX_PAYLOAD + 4];
+      transmit(std::string((char *)hello,
+        encodeBTFrame(hello, BT_HELLO, &version, 1)));
+      v2 = true;
+    }
+
+    level += (chargeMA - set.drainMA) * (TICK_MICROS / 3600e6) /
+             set.capacity * 100;
+    drawn += chargeMA * (TICK_MICROS / 1e6);
+    if(level > 100) level = 100;
+    if(level < 0)   level = 0;
+
+    // The app may be put to sleep once it has reported a level beyond
+    // asleepAbove while charging; losing power wakes it
+    if(!powered) asleep = false;
+    else if(set.asleepAbove && (reported >= set.asleepAbove)) asleep = true;
+    if(asleep) return;
+
+    // The app reports whole percentages, with heartbeats in between
+    if(((int)level != reported) &&
+       (now - lastLevelFrame >= set.reportEvery * 1000000ULL)) {
+      lastLevelFrame = now;
+      reported = (int)level;
+      send(false);
+    } else if(now - lastFrame >= set.heartbeat * 1000000ULL) {
+      send(true);
+    }
+
+    // Ask for the captures once the one after a switch is done
+    if(v2 && askAt && (now >= askAt)) {
+      uint8_t out[BT_MAX_PAYLOAD + 4];
+      transmit(std::string((char *)out,
+        encodeBTFrame(out, BT_CAPTURE, NULL, 0)));
+      askAt = 0;
+    }
+  }
+
+  double   level;     // Battery charge, %
+  int      reported;  // Last level sent to the charger
+  uint64_t lastFrame; // When the last frame was sent
+  uint32_t frames;    // Frames sent
+  uint32_t damaged;   // ... of which with line noise
+  uint32_t bytes;     // Bytes on air
+  bool     v2;        // Sending binary frames
+  double   drawn;     // Charge taken through the MOSFET, mA seconds
+  uint64_t lastLevelFrame;
+
+ private:
+  // Has the charger sent a HELLO for v2?
+  bool offered(void) {
+    uint32_t version = BT_VERSION;
+    uint8_t  hello[BT_MAX_PAYLOAD + 4];
+    uint8_t  length = encodeBTFrame(hello, BT_HELLO, &version, 1);
+    return host::btTx.find(std::string((char *)hello, length)) !=
+           std::string::npos;
+  }
+
+  void send(bool heartbeat) {
+    uint32_t t = (uint32_t)(host::nowMicros() / 1000000ULL);
+    char frame[20];
+    if(v2) {
+      // Plugged in, as the text frames say
+      uint32_t beat[2]   = { BT_FLAG_PLUGGED_IN, t % 86400 };
+      uint32_t levels[5] = { BT_FLAG_PLUGGED_IN, (uint32_t)reported,
+                             (uint32_t)set.maxCharge, (uint32_t)set.minCharge,
+                             t % 86400 };
+      uint8_t  out[BT_MAX_PAYLOAD + 4];
+      uint8_t  length = heartbeat ?
+        encodeBTFrame(out, BT_HEARTBEAT, beat, 2) :
+        encodeBTFrame(out, BT_LEVELS, levels, 5);
+      transmit(std::string((char *)out, length));
+    } else if(heartbeat) {
+      snprintf(frame, sizeof(frame), "%02u:%02u:%02uHEARTBEAT1",
+        (t / 3600) % 24, (t / 60) % 60, t % 60);
+    } else {
+      snprintf(frame, sizeof(frame), "%02u:%02u:%02u%03d%03d%03d1",
+        (t / 3600) % 24, (t / 60) % 60, t % 60, reported, set.maxCharge,
+        set.minCharge);
+    }
+    if(!v2) transmit(frame);
+    lastFrame = host::nowMicros();
+    frames++;
+  }
+
+  // Line noise: lose a byte or garble one
+  void transmit(std::string frame) {
+    if((uint32_t)(rand() % 1000) < set.errors) {
+      size_t at = rand() % frame.size();
+      if(rand() & 1) frame.erase(at, 1);
+      else           frame[at] = (char)(rand() & 0xFF);
+      damaged++;
+    }
+    host::btSend(frame);
+    bytes += frame.size();
+  }
+
+  const Settings    &set;
+  host::INA219Model &ina;
+  bool               powered;
+  uint64_t           poweredAt;
+  uint64_t           askAt;     // When to ask for the captures
+  bool               asleep;    // The app is sending nothing
+};
+
+// What the checks look at, gathered on every tick
+struct Results {
+  uint32_t switchOn, switchOff, badSwitches;
+  double   lowest, highest;      // Battery level after the first switch
+  uint64_t maxLatency, sumLatency; // Threshold frame to MOSFET change
+  uint32_t latencies;
+  uint64_t maxSample;   // MOSFET on to the sketch's next current reading
+  uint32_t earlySamples; // ... taken before the phone started charging
+  uint32_t estimated;   // MOSFET off before the phone reported maxCharge
+  double   estLow, estHigh; // Battery level at those
+};
+
+// The fields of each v2 frame of 'type' the sketch has sent so far
+static std::vector<std::vector<uint32_t> > sketchFrames(uint8_t type) {
+  const std::string &tx = host::btTx;
+  std::vector<std::vector<uint32_t> > frames;
+  for(size_t at = 0; at + 3 < tx.size(); at++) {
+    uint8_t length = tx[at + 2];
+    if(((uint8_t)tx[at] != BT_SYNC) ||
+       ((uint8_t)tx[at + 1] != (BT_VERSION << 4 | type)) ||
+       (at + length + 4 > tx.size())) continue;
+    uint8_t crc = 0;
+    for(size_t i = at + 1; i < at + length + 3; i++)
+      crc = crc8Update(crc, tx[i]);
+    if(crc != (uint8_t)tx[at + length + 3]) continue;
+
+    std::vector<uint32_t> fields;
+    uint8_t shift = 0;
+    for(size_t i = at + 3; i < at + length + 3; i++) {
+      if(!shift) fields.push_back(0);
+      fields.back() |= (uint32_t)(tx[i] & 0x7F) << shift;
+      shift += 7;
+      if(!(tx[i] & 0x80)) shift = 0;
+    }
+    frames.push_back(fields);
+    at += length + 3;
+  }
+  return frames;
+}
+
+// The sketch's telemetry records so far; the fields of the last one
+static uint32_t telemetry(uint32_t last[9]) {
+  std::vector<std::vector<uint32_t> > records =
+    sketchFrames(BT_TELEMETRY);
+  if(!records.empty()) {
+    for(uint8_t field = 0; field < 9; field++)
+      last[field] = field < records.back().size() ? records.back()[field] : 0;
+  }
+  return records.size();
+}
+
+// The captures as the sketch last sent them all; returns how many times
+// it did
+static uint32_t captureDumps(std::vector<uint8_t> &last) {
+  std::vector<std::vector<uint32_t> > chunks = sketchFrames(BT_CAPTURE);
+  std::vector<uint8_t> dump;
+  uint32_t dumps = 0;
+  for(size_t i = 0; i < chunks.size(); i++) {
+    const std::vector<uint32_t> &f = chunks[i];
+    if(f.size() < 2) continue;
+    if(!f[0]) dump.clear();
+    if(f[0] != dump.size()) continue; // Lost the start of this one
+    dump.insert(dump.end(), f.begin() + 2, f.end());
+    if(dump.size() == f[1]) {
+      last = dump;
+      dumps++;
+    }
+  }
+  return dumps;
+}
+
+// One capture decoded from the records in TransientCapture.h: the sample
+// taken at each conversion, -1 where one was missed
+struct Capture {
+  bool             on;
+  std::vector<int> mA;
+};
+
+static std::vector<Capture> decodeCaptures(const std::vector<uint8_t> &b) {
+  std::vector<Capture> captures;
+  int value = 0;
+  for(size_t at = 0; at < b.size(); at++) {
+    uint8_t first = b[at];
+    if(first >= 0xE0) {
+      if(at + 2 >= b.size()) break;
+      captures.push_back(Capture());
+      captures.back().on = first & 1;
+      value = b[at + 1] << 8 | b[at + 2];
+      captures.back().mA.push_back(value);
+      at += 2;
+      continue;
+    }
+    if(captures.empty()) break; // Not a capture's start
+    std::vector<int> &mA = captures.back().mA;
+    if(first < 0x80) {
+      value += (int8_t)(first << 1) >> 1;
+      mA.push_back(value);
+    } else if(first < 0xC0) {
+      mA.insert(mA.end(), (first & 0x3F) + 1, value);
+    } else if((first == 0xC1) && (at + 1 < b.size())) {
+      mA.insert(mA.end(), b[++at], -1);
+    } else if((first == 0xC0) && (at + 2 < b.size())) {
+      value = b[at + 1] << 8 | b[at + 2];
+      mA.push_back(value);
+      at += 2;
+    } else {
+      break;
+    }
+  }
+  return captures;
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "Usage: %s [-d days] [-c mAh] [-M max%%] [-m min%%] "
+    "[-S start%%]\n       [-C charge mA] [-D drain mA] [-H heartbeat s] "
+    "[-w charge start ms]\n       [-e errors per 1000 frames] [-b] "
+    "[-R INA219 resets per day]\n       [-P level report s] [-T] "
+    "[-A asleep above %%] [-F INA219 kHz,display kHz] [-f] [-v]\n",
+    argv0);
+  exit(1);
+}
+
+int main(int argc, char *argv[]) {
+  Settings set = { 7, 3000, 80, 30, 50, 1500, 250, 60, 2000, 0, false, 0, 0,
+                   false, 0, 0, 0, false, false };
+  int opt;
+  while((opt = getopt(argc, argv, "d:c:M:m:S:C:D:H:w:e:bR:P:TA:F:fvh")) != -1) {
+    switch(opt) {
+     case 'd': set.days        = atof(optarg); break;
+     case 'c': set.capacity    = atof(optarg); break;
+     case 'M': set.maxCharge   = atoi(optarg); break;
+     case 'm': set.minCharge   = atoi(optarg); break;
+     case 'S': set.startLevel  = atof(optarg); break;
+     case 'C': set.chargeMA    = atof(optarg); break;
+     case 'D': set.drainMA     = atof(optarg); break;
+     case 'H': set.heartbeat   = atoi(optarg); break;
+     case 'w': set.chargeDelay = atoi(optarg); break;
+     case 'e': set.errors      = atoi(optarg); break;
+     case 'b': set.binary      = true;         break;
+     case 'R': set.resets      = atof(optarg); break;
+     case 'P': set.reportEvery = atoi(optarg); break;
+     case 'T': set.captures    = true;         break;
+     case 'A': set.asleepAbove = atoi(optarg); break;
+     case 'F':
+      if(sscanf(optarg, "%u,%u", &set.ina219kHz, &set.displaykHz) != 2) {
+        usage(argv[0]);
+      }
+      break;
+     case 'f': set.frameDiff   = true;         break;
+     case 'v': set.verbose     = true;         break;
+     default:  usage(argv[0]);
+    }
+  }
+
+  host::setVirtualTime(true);
+  host::SSD1306Panel panel(128, 32);
+  host::INA219Model  ina219;
+  panel.maxClock  = set.displaykHz * 1000;
+  ina219.maxClock = set.ina219kHz * 1000;
+  host::attachI2C(0x3C, &panel);
+  host::attachI2C(0x40, &ina219);
+  host::setPinInput(CONNECTED_STATE_PIN, HIGH);
+
+  Phone   phone(set, ina219);
+  Results res = { 0, 0, 0, 100, 0, 0, 0, 0, 0, 0, 0, 100, 0 };
+  size_t  pinSeen   = 0;
+  bool    cycling   = false; // Seen the first switch, levels now bounded
+  int     lastOn    = -1;
+  uint64_t crossedAt = 0;    // Frame that first asked for a switch
+  uint64_t end = (uint64_t)(set.days * 86400e6);
+  uint64_t switchedOnAt = 0; // Waiting for the first current reading
+
+  // Is the first current reading after switching on (the sketch stalls
+  // 2250ms for this) taken once the phone is actually charging?
+  // (Captures read it too, with the INA219 in a continuous mode.) The
+  // phone's current follows the MOSFET between ticks.
+  ina219.onRead = [&](uint8_t reg) {
+    phone.follow();
+    if((reg != 4) || ((ina219.reg(0) & 7) > 4) || !switchedOnAt) return;
+    uint64_t after = host::nowMicros() - switchedOnAt;
+    if(after > res.maxSample) res.maxSample = after;
+    if(after < set.chargeDelay * 1000ULL) res.earlySamples++;
+    switchedOnAt = 0;
+  };
+
+  // The battery model and the phone run on their own 1s tick
+  std::function<void()> tick = [&]() {
+    // Switches since the last tick answer the frames sent up to then, or
+    // the sketch's estimate of the level since (to within a percent)
+    bool reportedOff = phone.reported >= set.maxCharge;
+    bool wantOff = reportedOff || (phone.level >= set.maxCharge - 1);
+    bool wantOn  = phone.reported <= set.minCharge;
+    for(; pinSeen < host::pinLog.size(); pinSeen++) {
+      const host::PinEvent &e = host::pinLog[pinSeen];
+      if((e.pin != PWR_CONTROL_PIN) || (e.value == lastOn)) continue;
+      if(lastOn >= 0) {
+        bool ok = e.value ? wantOn : wantOff;
+        if(e.value) {
+          res.switchOn++;
+          switchedOnAt = e.us;
+        } else {
+          res.switchOff++;
+          if(!reportedOff) {
+            res.estimated++;
+            res.estLow  = std::min(res.estLow, phone.level);
+            res.estHigh = std::max(res.estHigh, phone.level);
+          }
+        }
+        if(!ok) res.badSwitches++;
+        if(crossedAt) {
+          uint64_t latency = e.us - crossedAt;
+          if(latency > res.maxLatency) res.maxLatency = latency;
+          res.sumLatency += latency;
+          res.latencies++;
+        }
+        if(set.verbose || !ok) {
+          printf("%8.3f h  MOSFET %s at %d%% (%.2f%%)%s\n", e.us / 3600e6,
+            e.value ? "on " : "off", phone.reported, phone.level,
+            ok ? "" : "  <-- outside hysteresis");
+        }
+        cycling = true;
+      }
+      lastOn    = e.value;
+      crossedAt = 0;
+    }
+
+    phone.tick();
+
+    bool on = host::pinOutput(PWR_CONTROL_PIN) == HIGH;
+    if(!crossedAt && ((on && (phone.reported >= set.maxCharge)) ||
+                      (!on && (phone.reported <= set.minCharge))))
+      crossedAt = phone.lastFrame;
+
+    if(cycling) {
+      if(phone.level < res.lowest)  res.lowest  = phone.level;
+      if(phone.level > res.highest) res.highest = phone.level;
+    }
+    host::schedule(host::nowMicros() + TICK_MICROS, tick);
+  };
+  host::schedule(0, tick);
+
+  // Knock the INA219 back to its power-on defaults now and then
+  uint32_t resets = 0;
+  std::function<void()> reset = [&]() {
+    ina219.powerOnReset();
+    resets++;
+    host::schedule(host::nowMicros() + (uint64_t)(86400e6 / set.resets *
+      (0.5 + (double)rand() / RAND_MAX)), reset);
+  };
+  if(set.resets > 0) host::schedule((uint64_t)(86400e6 / set.resets), reset);
+
+  setup();
+  if(set.frameDiff && !::display.setFrameDiff(true)) {
+    fprintf(stderr, "No memory for the display's frame copy\n");
+    return 1;
+  }
+  while(host::nowMicros() < end) loop();
+
+  // Sent like any other frame (dirty spans, or runs against the frame
+  // copy), so a change the flushes lost shows up as a mismatch
+  ::display.display();
+  bool panelMatches = !memcmp(panel.ram(), ::display.getBuffer(),
+    panel.ramSize());
+
+  uint32_t overflows = host::btOverflows;
+  // The app reports each level once, so a frame lost to line noise lets
+  // the battery run a percent further, and one reporting less often lets
+  // it run on until the next report: only hold a clean, prompt link to the
+  // band. An app asleep above maxCharge leaves it to the taper, which may
+  // run a percent or two over.
+  bool bounded = cycling && (set.errors || set.reportEvery ||
+                 ((res.lowest  >= set.minCharge - 1) &&
+                  (res.highest <= set.maxCharge + (set.asleepAbove ? 2 : 1))));
+
+  printf("Simulated %.1f days: %u frames sent, %u MOSFET on, %u off\n",
+    set.days, phone.frames, res.switchOn, res.switchOff);
+  printf("Frames: protocol v%u, %u bytes on air, %u damaged in transit; "
+    "parsed %u good, %u bad, %u dropped\n", btParser.peerVersion, phone.bytes,
+    phone.damaged, btParser.goodFrames, btParser.badFrames,
+    btParser.droppedFrames);
+  printf("Battery after first switch: %.2f%% .. %.2f%% (limits %d%% .. %d%%)\n",
+    res.lowest, res.highest, set.minCharge, set.maxCharge);
+  if(res.estimated) {
+    printf("MOSFET off on the sketch's estimate: %u times, battery at "
+      "%.2f%% .. %.2f%%\n", res.estimated, res.estLow, res.estHigh);
+  }
+  if(res.latencies) {
+    printf("Frame to MOSFET latency: mean %.0f ms, max %.0f ms\n",
+      res.sumLatency / 1000.0 / res.latencies, res.maxLatency / 1000.0);
+  }
+  if(res.switchOn) {
+    printf("First current reading after switch on: max %.0f ms, %u before "
+      "charging started (%u ms)\n", res.maxSample / 1000.0, res.earlySamples,
+      set.chargeDelay);
+  }
+  uint32_t last[9] = { 0 };
+  uint32_t records = telemetry(last);
+  if(records) {
+    printf("Telemetry: %u records, last %u mA (%u .. %u), %s; parser %u "
+      "good, %u bad, %u dropped\n", records, last[1], last[2], last[3],
+      (last[0] & BT_FLAG_CHARGING) ? "charging" : "not charging", last[5],
+      last[6], last[7]);
+    // The model's bus is at 5V
+    printf("Delivered: %u mAh, %u mWh (model %.0f mAh, %.0f mWh)\n", last[4],
+      last[8], phone.drawn / 3600, phone.drawn / 3600 * 5);
+  }
+  if(set.captures) {
+    std::vector<uint8_t> dump;
+    uint32_t dumps = captureDumps(dump);
+    std::vector<Capture> captures = decodeCaptures(dump);
+    printf("Captures: sent %u times, the last %zu bytes holding %zu\n", dumps,
+      dump.size(), captures.size());
+
+    // When did the phone start charging after the last switch on?
+    for(size_t i = captures.size(); i-- > 0;) {
+      if(!captures[i].on) continue;
+      const std::vector<int> &mA = captures[i].mA;
+      size_t missed = std::count(mA.begin(), mA.end(), -1);
+      size_t rise   = 0;
+      while((rise < mA.size()) &&
+            (mA[rise] < PWR_LED_MILLIAMPS + set.chargeMA / 2)) rise++;
+      printf("After switching on: %zu conversions (%.0f ms), %zu missed; ",
+        mA.size(), mA.size() * CONVERSION_MICROS / 1000.0, missed);
+      if(rise < mA.size()) {
+        printf("charging started at %.1f ms (model %u ms)\n",
+          rise * CONVERSION_MICROS / 1000.0, set.chargeDelay);
+      } else {
+        printf("charging had not started\n");
+      }
+      break;
+    }
+  }
+  if(resets) {
+    printf("INA219: %u resets, %u found and recalibrated by the sketch\n",
+      resets, ::ina219.resets);
+  }
+  printf("BT RX overflow: %u bytes\n", overflows);
+  for(std::map<uint8_t, host::BusStats>::const_iterator it =
+      host::busStats.begin(); it != host::busStats.end(); ++it) {
+    printf("I2C 0x%02X: %u transactions, %.1f s on the wire\n", it->first,
+      it->second.transactions, it->second.wireMicros / 1e6);
+  }
+  printf("INA219 wait for the bus: mean %.0f us, max %u us over "
+    "%u readings; display flush gave way %u times\n",
+    ina219Bus.requests ? (double)ina219Bus.waitMicros / ina219Bus.requests : 0,
+    ina219Bus.maxWaitMicros, ina219Bus.requests, displayBus.preemptions);
+  printf("Display: %u data bytes, %u command bytes; panel %s the frame\n",
+    panel.dataBytes, panel.commandBytes,
+    panelMatches ? "shows" : "DIFFERS from");
+  printf("I2C clocks: INA219 %u kHz, display %u kHz; %u EEPROM writes\n",
+    ina219Bus.clock / 1000, displayBus.clock / 1000, host::eepromWrites);
+
+  if((set.ina219kHz && (ina219Bus.clock > set.ina219kHz * 1000)) ||
+     (set.displaykHz && (displayBus.clock > set.displaykHz * 1000))) {
+    printf("FAIL: I2C clock tuned above what a device keeps up with\n");
+    return 1;
+  }
+  if(ina219Bus.clock > 400000UL) { // However well the model reads back
+    printf("FAIL: INA219 clock above its 400 kHz rating\n");
+    return 1;
+  }
+  if(!panelMatches) {
+    printf("FAIL: the panel does not show the sketch's frame\n");
+    return 1;
+  }
+
+  if(res.badSwitches || !bounded) {
+    printf("FAIL: %u switches outside the hysteresis band%s\n",
+      res.badSwitches, bounded ? "" : ", battery left the band");
+    return 1;
+  }
+  printf("PASS\n");
+  return 0;
+}
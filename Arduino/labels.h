@@ -0,0 +1,82 @@
+
+// Generated by make_labels.py, text size 2
+
+#define label_CHARGE_width 70
+#define label_CHARGE_pages 2
+
+const uint8_t PROGMEM label_CHARGE_data[] = {
+  // page 0
+  0xFC,0xFC,0x03,0x03,0x03,0x03,0x03,0x03,0x0C,0x0C,0x00,0x00,
+  0xFF,0xFF,0xC0,0xC0,0xC0,0xC0,0xC0,0xC0,0xFF,0xFF,0x00,0x00,
+  0xF0,0xF0,0x0C,0x0C,0x03,0x03,0x0C,0x0C,0xF0,0xF0,0x00,0x00,
+  0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x3C,0x3C,0x00,0x00,
+  0xFC,0xFC,0x03,0x03,0x03,0x03,0x03,0x03,0x0F,0x0F,0x00,0x00,
+  0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x03,0x03,
+  // page 1
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x30,0x30,0x0C,0x0C,0x00,0x00,
+  0x3F,0x3F,0x00,0x00,0x00,0x00,0x00,0x00,0x3F,0x3F,0x00,0x00,
+  0x3F,0x3F,0x03,0x03,0x03,0x03,0x03,0x03,0x3F,0x3F,0x00,0x00,
+  0x3F,0x3F,0x00,0x00,0x03,0x03,0x0C,0x0C,0x30,0x30,0x00,0x00,
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x33,0x33,0x3F,0x3F,0x00,0x00,
+  0x3F,0x3F,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,
+};
+
+#define label_PAUSED_width 70
+#define label_PAUSED_pages 2
+
+const uint8_t PROGMEM label_PAUSED_data[] = {
+  // page 0
+  0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x3C,0x3C,0x00,0x00,
+  0xF0,0xF0,0x0C,0x0C,0x03,0x03,0x0C,0x0C,0xF0,0xF0,0x00,0x00,
+  0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x00,0x00,
+  0x3C,0x3C,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x0C,0x0C,0x00,0x00,
+  0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x03,0x03,0x00,0x00,
+  0xFF,0xFF,0x03,0x03,0x03,0x03,0x03,0x03,0xFC,0xFC,
+  // page 1
+  0x3F,0x3F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,
+  0x3F,0x3F,0x03,0x03,0x03,0x03,0x03,0x03,0x3F,0x3F,0x00,0x00,
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x30,0x30,0x0F,0x0F,0x00,0x00,
+  0x0C,0x0C,0x30,0x30,0x30,0x30,0x30,0x30,0x0F,0x0F,0x00,0x00,
+  0x3F,0x3F,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x00,0x00,
+  0x3F,0x3F,0x30,0x30,0x30,0x30,0x30,0x30,0x0F,0x0F,
+};
+
+#define label_NOT_width 34
+#define label_NOT_pages 2
+
+const uint8_t PROGMEM label_NOT_data[] = {
+  // page 0
+  0xFF,0xFF,0x30,0x30,0xC0,0xC0,0x00,0x00,0xFF,0xFF,0x00,0x00,
+  0xFC,0xFC,0x03,0x03,0x03,0x03,0x03,0x03,0xFC,0xFC,0x00,0x00,
+  0x0F,0x0F,0x03,0x03,0xFF,0xFF,0x03,0x03,0x0F,0x0F,
+  // page 1
+  0x3F,0x3F,0x00,0x00,0x00,0x00,0x03,0x03,0x3F,0x3F,0x00,0x00,
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x30,0x30,0x0F,0x0F,0x00,0x00,
+  0x00,0x00,0x00,0x00,0x3F,0x3F,0x00,0x00,0x00,0x00,
+};
+
+#define label_CONNECTED_width 106
+#define label_CONNECTED_pages 2
+
+const uint8_t PROGMEM label_CONNECTED_data[] = {
+  // page 0
+  0xFC,0xFC,0x03,0x03,0x03,0x03,0x03,0x03,0x0C,0x0C,0x00,0x00,
+  0xFC,0xFC,0x03,0x03,0x03,0x03,0x03,0x03,0xFC,0xFC,0x00,0x00,
+  0xFF,0xFF,0x30,0x30,0xC0,0xC0,0x00,0x00,0xFF,0xFF,0x00,0x00,
+  0xFF,0xFF,0x30,0x30,0xC0,0xC0,0x00,0x00,0xFF,0xFF,0x00,0x00,
+  0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x03,0x03,0x00,0x00,
+  0xFC,0xFC,0x03,0x03,0x03,0x03,0x03,0x03,0x0C,0x0C,0x00,0x00,
+  0x0F,0x0F,0x03,0x03,0xFF,0xFF,0x03,0x03,0x0F,0x0F,0x00,0x00,
+  0xFF,0xFF,0xC3,0xC3,0xC3,0xC3,0xC3,0xC3,0x03,0x03,0x00,0x00,
+  0xFF,0xFF,0x03,0x03,0x03,0x03,0x03,0x03,0xFC,0xFC,
+  // page 1
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x30,0x30,0x0C,0x0C,0x00,0x00,
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x30,0x30,0x0F,0x0F,0x00,0x00,
+  0x3F,0x3F,0x00,0x00,0x00,0x00,0x03,0x03,0x3F,0x3F,0x00,0x00,
+  0x3F,0x3F,0x00,0x00,0x00,0x00,0x03,0x03,0x3F,0x3F,0x00,0x00,
+  0x3F,0x3F,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x00,0x00,
+  0x0F,0x0F,0x30,0x30,0x30,0x30,0x30,0x30,0x0C,0x0C,0x00,0x00,
+  0x00,0x00,0x00,0x00,0x3F,0x3F,0x00,0x00,0x00,0x00,0x00,0x00,
+  0x3F,0x3F,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x30,0x00,0x00,
+  0x3F,0x3F,0x30,0x30,0x30,0x30,0x30,0x30,0x0F,0x0F,
+};